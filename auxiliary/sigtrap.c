@@ -5,9 +5,20 @@
   
   usage:
   
-    sigtrap [n]
+    sigtrap [-s] [-w workload] [-c fd:slot] [n]
       
     [n] is time for process to exist - default 60 seconds 
+    -w  what to do for each tick instead of sleeping, and leave the
+        process priority to whoever launched it:
+          spin    burn a second of CPU on an integer loop
+          stream  burn a second of CPU streaming through 32MB of memory
+          chase   burn a second of CPU chasing pointers through 32MB
+          io      write, sync and read back a temporary file for a
+                  second, pausing briefly after every burst
+          sleep   just sleep (the default)
+    -s  same as -w spin
+    -c  cooperative worker mode: park, unpark and exit as told by the
+        control word of slot [slot] in the shared channel on [fd]
     
   program ticks away reporting process id and tick count every
   second. the program traps and reports the following signals:
@@ -62,6 +73,10 @@
 #include <sys/times.h>
 #include <limits.h>
 #include <sys/resource.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <channel.h>
 
 #ifndef TRUE
 #define TRUE 1
@@ -73,9 +88,34 @@
 
 static void SignalHandler(int);
 void        PrintUsage(char*);   // for error exit & info 
+static int  Work(int);           // run a workload for a second
+static int  Interrupted(void);   // has a signal or the channel cut in
+static void Spin(void);          // one chunk of each workload
+static void Stream(void);
+static void Chase(void);
+static void Io(void);
+static int  Wait(void);          // sleep a second on the control word
+static void Park(void);          // park until told to run again
+static int  Attach(char*);       // map our slot of the control channel
 char       *StripPath(char*);    // strip path from filename
 
 #define DEFAULT_TIME 60
+
+#define WORK_SLEEP  0            // workloads (-w)
+#define WORK_SPIN   1
+#define WORK_STREAM 2
+#define WORK_CHASE  3
+#define WORK_IO     4
+
+#define SPIN_CHUNK   (256 * 1024)       // integer steps per chunk
+#define STREAM_WORDS (2 * 1024 * 1024)  // doubles per stream array
+#define STREAM_CHUNK (64 * 1024)
+#define CHASE_WORDS  (4 * 1024 * 1024)  // links in the chase ring
+#define CHASE_CHUNK  (64 * 1024)
+#define IO_BLOCK     (64 * 1024)        // bytes per write
+#define IO_SPAN      (16 * 1024 * 1024) // file size before wrapping
+#define IO_BURST     16                 // writes between syncs
+#define IO_PAUSE_NS  10000000L          // pause after every burst
 #define DEFAULT_OP   stdout
 #define DEFAULT_NAME "sigtrap"
 
@@ -123,6 +163,8 @@ static int signal_SIGABRT = FALSE;
 static int signal_SIGCONT = FALSE;
 static int signal_SIGTSTP = FALSE;
 
+static WorkerSlot * slot = NULL;      // control channel slot (-c only)
+
 /*******************************************************************/
 
 int main(int argc, char *argv[])
@@ -134,8 +176,37 @@ int main(int argc, char *argv[])
     struct tms t;
     clock_t starttick, stoptick;
     sigset_t mask;
+    int work = WORK_SLEEP;
+    char * name = argv[0];
     
     colour = colours[pid % N_COLOUR]; // select colour for this process
+
+    while (argc > 1 && argv[1][0] == '-') {
+        if (!strcmp(argv[1], "-s"))
+            work = WORK_SPIN;         // consume CPU rather than sleep
+        else if (!strcmp(argv[1], "-w") && argc > 2) {
+            if (!strcmp(argv[2], "spin"))
+                work = WORK_SPIN;
+            else if (!strcmp(argv[2], "stream"))
+                work = WORK_STREAM;
+            else if (!strcmp(argv[2], "chase"))
+                work = WORK_CHASE;
+            else if (!strcmp(argv[2], "io"))
+                work = WORK_IO;
+            else if (!strcmp(argv[2], "sleep"))
+                work = WORK_SLEEP;
+            else
+                PrintUsage(name);
+            argc--; argv++;
+        }
+        else if (!strcmp(argv[1], "-c") && argc > 2 && Attach(argv[2])) {
+            argc--; argv++;           // cooperative worker
+        }
+        else
+            PrintUsage(name);
+        argc--; argv++;
+    }
+    argv[0] = name;
 	
     if (argc > 2 || (argc == 2 && !isdigit((int)argv[1][0])))
         PrintUsage(argv[0]);	
@@ -152,7 +223,8 @@ int main(int argc, char *argv[])
                                       // due to Darwin/BSD inconsistent SIGCONT behaviour
     signal (SIGTSTP, SignalHandler);
                                         	
-    rc = setpriority(PRIO_PROCESS, 0, 20); // be nice, lower priority by 20 	
+    if (work == WORK_SLEEP)
+        rc = setpriority(PRIO_PROCESS, 0, 20); // be nice, lower priority by 20 	
     cycle = argc < 2 ? DEFAULT_TIME : atoi(argv[1]);  // get tick count 
     if (cycle <= 0) cycle = 1;
 
@@ -165,7 +237,10 @@ int main(int argc, char *argv[])
         }
             
         starttick = times (&t);        // use timer to ascertain whether 'tick' should be
-        rc = sleep(1);                 //  reported
+        if (work != WORK_SLEEP)        //  reported
+            rc = Work(work);
+        else
+            rc = slot ? Wait() : (int) sleep(1);
         stoptick = times (&t);
          
         if (rc == 0 || (stoptick-starttick) > clktck/2)
@@ -205,6 +280,21 @@ int main(int argc, char *argv[])
             fprintf(output,"%s%7d; SIGTERM" BLACK NORMAL "\n", colour, (int) pid);
             exit(0);
         }                
+        if (slot) {
+            if (rc == 0)
+                __atomic_add_fetch(&slot->progress, 1, __ATOMIC_RELAXED);
+            switch (__atomic_load_n(&slot->control, __ATOMIC_ACQUIRE)) {
+                case CHANNEL_EXIT:
+                    fprintf(output,"%s%7d; EXIT" BLACK NORMAL "\n", colour, (int) pid);
+                    exit(0);
+                case CHANNEL_PARK:
+                    fprintf(output,"%s%7d; PARK" BLACK NORMAL "\n", colour, (int) pid);
+                    fflush(output);
+                    Park();
+                    fprintf(output,"%s%7d; UNPARK" BLACK NORMAL "\n", colour, (int) pid);
+                    break;
+            }
+        }
         fflush(output);
     }
     exit(0);
@@ -251,6 +341,261 @@ static void SignalHandler(int sig)        // trap signals from shell/system
     }
 }
 
+/*******************************************************************
+
+  static int Interrupted(void)
+
+  returns TRUE if a trapped signal or a new control word is waiting
+  to be acted on, FALSE otherwise
+ *******************************************************************/
+
+static int Interrupted(void)
+{
+    if (signal_SIGINT || signal_SIGQUIT || signal_SIGHUP ||
+        signal_SIGTERM || signal_SIGABRT || signal_SIGTSTP)
+        return TRUE;
+    if (slot && __atomic_load_n(&slot->control, __ATOMIC_RELAXED) != CHANNEL_RUN)
+        return TRUE;
+    return FALSE;
+}
+
+/*******************************************************************
+
+  static int Work(int work)
+
+  run workload [work] for one second, a chunk at a time, returning
+  early if a signal or the control channel cuts in so that it is
+  acted on straight away. the second is process CPU time except for
+  the io workload, which mostly waits and so counts wall time
+
+  returns 0 if the full second was used, 1 otherwise (as sleep())
+ *******************************************************************/
+
+static int Work(int work)
+{
+    clockid_t clock = work == WORK_IO ? CLOCK_MONOTONIC : CLOCK_PROCESS_CPUTIME_ID;
+    struct timespec start, now;
+
+    clock_gettime(clock, &start);
+    do {
+        if (Interrupted())
+            return 1;
+        switch (work) {
+            case WORK_SPIN:
+                Spin();
+                break;
+            case WORK_STREAM:
+                Stream();
+                break;
+            case WORK_CHASE:
+                Chase();
+                break;
+            case WORK_IO:
+                Io();
+                break;
+        }
+        clock_gettime(clock, &now);
+    } while ((now.tv_sec - start.tv_sec) * 1000000000L +
+             (now.tv_nsec - start.tv_nsec) < 1000000000L);
+
+    return 0;
+}
+
+/*******************************************************************
+
+  static void Spin(void)
+
+  one chunk of an xorshift loop that stays in registers
+ *******************************************************************/
+
+static void Spin(void)
+{
+    static volatile unsigned long sink = 0;
+    unsigned long x = sink | 1;
+    int i;
+
+    for (i = 0; i < SPIN_CHUNK; i++) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+    }
+    sink = x;
+}
+
+/*******************************************************************
+
+  static void Stream(void)
+
+  one chunk of a STREAM-style triad over two arrays far larger than
+  the caches, so that it is bound by memory bandwidth
+ *******************************************************************/
+
+static void Stream(void)
+{
+    static double * a = NULL, * b = NULL;
+    static size_t at = 0;
+    size_t i, end;
+
+    if (!a) {
+        if (!(a = malloc(STREAM_WORDS * sizeof(double))) ||
+            !(b = malloc(STREAM_WORDS * sizeof(double))))
+            exit(1);
+        for (i = 0; i < STREAM_WORDS; i++) {
+            a[i] = 1.0;
+            b[i] = 2.0;
+        }
+    }
+
+    for (i = at, end = at + STREAM_CHUNK; i < end; i++)
+        a[i] = a[i] + 3.0 * b[i];
+    at = end % STREAM_WORDS;
+}
+
+/*******************************************************************
+
+  static void Chase(void)
+
+  one chunk of hops around a random single-cycle permutation far
+  larger than the caches, so that nearly every hop misses
+ *******************************************************************/
+
+static void Chase(void)
+{
+    static size_t * ring = NULL;
+    static volatile size_t at = 0;
+    size_t i, j, swap, next = at;
+
+    if (!ring) {
+        if (!(ring = malloc(CHASE_WORDS * sizeof(size_t))))
+            exit(1);
+        for (i = 0; i < CHASE_WORDS; i++)
+            ring[i] = i;
+        srand(getpid());
+        for (i = CHASE_WORDS - 1; i > 0; i--) {   // Sattolo's shuffle
+            j = ((size_t)rand() * RAND_MAX + rand()) % i;
+            swap = ring[i]; ring[i] = ring[j]; ring[j] = swap;
+        }
+    }
+
+    for (i = 0; i < CHASE_CHUNK; i++)
+        next = ring[next];
+    at = next;
+}
+
+/*******************************************************************
+
+  static void Io(void)
+
+  one burst of writes to an unlinked temporary file, synced and read
+  back, followed by a short pause. the pause is cut short by the
+  control channel or a signal
+ *******************************************************************/
+
+static void Io(void)
+{
+    static int fd = -1;
+    static off_t offset = 0;
+    static char block[IO_BLOCK];
+    char path[] = "/tmp/sigtrapXXXXXX";
+    struct timespec pause = { 0, IO_PAUSE_NS };
+    int i;
+
+    if (fd < 0) {
+        if ((fd = mkstemp(path)) < 0)
+            exit(1);
+        unlink(path);
+        memset(block, getpid() & 0xff, sizeof(block));
+    }
+
+    for (i = 0; i < IO_BURST; i++) {
+        if (pwrite(fd, block, IO_BLOCK, offset) != IO_BLOCK ||
+            pread(fd, block, IO_BLOCK, offset) != IO_BLOCK)
+            exit(1);
+        offset = (offset + IO_BLOCK) % IO_SPAN;
+    }
+    fdatasync(fd);
+
+    if (slot)
+        syscall(SYS_futex, &slot->control, FUTEX_WAIT, CHANNEL_RUN,
+                &pause, NULL, 0);
+    else
+        nanosleep(&pause, NULL);
+}
+
+/*******************************************************************
+
+  static int Wait(void)
+
+  sleep for one second on the control word of our slot, waking up as
+  soon as the dispatcher changes it (or a signal arrives)
+
+  returns 0 if the full second passed, 1 otherwise (as sleep())
+ *******************************************************************/
+
+static int Wait(void)
+{
+    struct timespec second = { 1, 0 };
+
+    if (syscall(SYS_futex, &slot->control, FUTEX_WAIT, CHANNEL_RUN,
+                &second, NULL, 0) < 0 && errno == ETIMEDOUT)
+        return 0;
+
+    return 1;
+}
+
+/*******************************************************************
+
+  static void Park(void)
+
+  acknowledge a park request and wait on the control word until the
+  dispatcher asks us to run or exit. this is what stands in for
+  SIGTSTP/SIGCONT in cooperative worker mode
+ *******************************************************************/
+
+static void Park(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    slot->parked_at = (int64_t)now.tv_sec * 1000000000L + now.tv_nsec;
+    __atomic_store_n(&slot->state, CHANNEL_PARKED, __ATOMIC_RELEASE);
+
+    while (__atomic_load_n(&slot->control, __ATOMIC_ACQUIRE) == CHANNEL_PARK)
+        syscall(SYS_futex, &slot->control, FUTEX_WAIT, CHANNEL_PARK,
+                NULL, NULL, 0);
+
+    __atomic_store_n(&slot->state, CHANNEL_RUNNING, __ATOMIC_RELEASE);
+}
+
+/*******************************************************************
+
+  static int Attach(char * where)
+
+  map the control channel and find our slot. [where] is "fd:slot"
+  as passed by the dispatcher
+
+  returns TRUE if attached, FALSE otherwise
+ *******************************************************************/
+
+static int Attach(char * where)
+{
+    int fd, index;
+    WorkerSlot * slots;
+
+    if (sscanf(where, "%d:%d", &fd, &index) != 2 ||
+        index < 0 || index >= CHANNEL_MAX_SLOTS)
+        return FALSE;
+
+    slots = mmap(NULL, CHANNEL_MAX_SLOTS * sizeof(WorkerSlot),
+                 PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (slots == MAP_FAILED)
+        return FALSE;
+
+    slot = &slots[index];
+    return TRUE;
+}
+
 /*******************************************************************
    
   void PrintUsage(char * pgmName)
@@ -270,8 +615,14 @@ void PrintUsage(char * pgmName)
     printf("\n"
            "  program: %s - trap and report process control signals\n\n"
            "    usage:\n\n"
-           "      %s [seconds]\n\n"
-           "      where [seconds] is the lifetime of the program - default = 60s.\n\n"
+           "      %s [-s] [-w workload] [-c fd:slot] [seconds]\n\n"
+           "      where [seconds] is the lifetime of the program - default = 60s.\n"
+           "      -w runs a workload for each tick instead of sleeping and keeps\n"
+           "      the priority it was launched with. [workload] is one of spin\n"
+           "      (integer loop), stream (memory bandwidth), chase (cache misses),\n"
+           "      io (periodic file writes and syncs) or sleep. -s is -w spin.\n"
+           "      -c parks, unparks and exits as told by slot [slot] of the\n"
+           "      shared control channel on descriptor [fd].\n\n"
            "    the program sleeps for a second, reports process id and tick count\n"
            "    before sleeping again. any process control signals: SIGINT, SIGQUIT\n"
            "    SIGHUP, SIGTERM, SIGABRT, SIGCONT, SIGTSTP, are trapped and\n"
@@ -0,0 +1,47 @@
+#ifndef ADAPT
+#define ADAPT
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+
+/*
+SECTION 1B: OTHER INCLUDES
+*/
+#include <pcb.h>
+
+/*
+SECTION 2: ADAPTIVE QUANTUM MACROS
+*/
+#define ADAPT_LEVELS (3)
+#define ADAPT_MAX_WINDOW (1024)
+#define ADAPT_MIN_SAMPLES (4)
+#define ADAPT_DEFAULT_WINDOW (32)
+#define ADAPT_DEFAULT_TARGET (0.8)
+#define ADAPT_DEFAULT_MIN (1)
+#define ADAPT_DEFAULT_MAX (64)
+
+/*
+SECTION 3: SLIDING WINDOW STRUCTURE
+*/
+typedef struct
+{
+    int consumed[ADAPT_MAX_WINDOW];
+    char finished[ADAPT_MAX_WINDOW];
+    int head;
+    int count;
+    char dirty;
+} LevelWindow;
+
+/*
+SECTION 4: FUNCTION PROTOTYPES
+*/
+void configureAdaptation(int, double, unsigned int, unsigned int);
+unsigned int boundQuantum(unsigned int);
+void observeExit(int, char, int);
+char adaptQuantum(int, unsigned int *, uint64_t);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef CGROUP
+#define CGROUP
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <mntent.h>
+
+/*
+SECTION 1B: SYSTEM CALL HEADER FILES
+*/
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/*
+SECTION 1C: OTHER INCLUDES
+*/
+#include <pcb.h>
+
+/*
+SECTION 2: CGROUP MACROS
+*/
+#define CGROUP_LINE_MAX (512)
+#define CGROUP_VALUE_MAX (32)
+#define CGROUP_INITIAL_RETIRED (16)
+#define CGROUP_CLEANUP_ATTEMPTS (10)
+#define CGROUP_CLEANUP_WAIT_US (10000)
+#define CGROUP_LEAF_ROOM (64)
+
+/*
+SECTION 3: FUNCTION PROTOTYPES
+*/
+char initializeCgroups(void);
+char attachCgroup(pid_t);
+char freezeCgroup(pid_t, char);
+uint64_t readCgroupUsage(pid_t);
+void retireCgroup(pid_t);
+void sweepCgroups(void);
+void cleanupCgroups(void);
+
+#endif
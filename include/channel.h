@@ -0,0 +1,71 @@
+#ifndef CHANNEL
+#define CHANNEL
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <time.h>
+
+/*
+SECTION 1B: SYSTEM CALL HEADER FILES
+*/
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/*
+SECTION 2: CONTROL CHANNEL MACROS
+*/
+#define CHANNEL_RUN (0)
+#define CHANNEL_PARK (1)
+#define CHANNEL_EXIT (2)
+
+#define CHANNEL_RUNNING (0)
+#define CHANNEL_PARKED (1)
+
+#define CHANNEL_NO_SLOT (-1)
+#define CHANNEL_MAX_SLOTS (4096)
+#define CHANNEL_SLOT_ALIGN (64)
+#define CHANNEL_ARG_MAX (24)
+#define CHANNEL_FLAG "-c"
+
+/*
+SECTION 3: WORKER SLOT STRUCTURE
+*/
+/*
+NOTE:
+    - One slot per cooperative worker, in a region shared by the dispatcher
+    and every worker. The dispatcher writes `control` and the worker writes
+    the rest. `control` and `state` double as futex words. Slots are a cache
+    line each so that workers never contend on a line.
+*/
+typedef struct
+{
+    uint32_t control;
+    uint32_t state;
+    uint64_t progress;
+    int64_t requested_at;
+    int64_t parked_at;
+    pid_t pid;
+} __attribute__((aligned(CHANNEL_SLOT_ALIGN))) WorkerSlot;
+
+/*
+SECTION 4: FUNCTION PROTOTYPES
+*/
+char initializeChannel(void);
+int openSlot(char *);
+void bindSlot(int, pid_t);
+void parkSlot(int);
+void unparkSlot(int);
+void exitSlot(int);
+void printChannelStats(void);
+
+#endif
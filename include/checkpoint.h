@@ -0,0 +1,75 @@
+#ifndef CHECKPOINT
+#define CHECKPOINT
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <libgen.h>
+
+/*
+SECTION 1B: SYSTEM CALL HEADER FILES
+*/
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/*
+SECTION 1C: OTHER INCLUDES
+*/
+#include <pcb.h>
+#include <event.h>
+
+/*
+SECTION 2: CHECKPOINT MACROS
+*/
+#define CHECKPOINT_MAGIC "DISPCKPT"
+#define CHECKPOINT_MAGIC_SIZE (8)
+#define CHECKPOINT_VERSION (3)
+#define CHECKPOINT_INITIAL_CAPACITY (4096)
+#define CHECKPOINT_DEFAULT_EVERY (60)
+#define CHECKPOINT_TEMP_SUFFIX ".tmp"
+#define CHECKPOINT_FNV_OFFSET (14695981039346656037ULL)
+#define CHECKPOINT_FNV_PRIME (1099511628211ULL)
+
+/*
+SECTION 3: CHECKPOINT STRUCTURE
+*/
+/*
+NOTE:
+    - Starts every checkpoint file. `size` is the length of what follows and
+    `checksum` its FNV-1a hash, so a file cut short or damaged is never taken
+    for a checkpoint. `version` is raised whenever what the dispatcher puts
+    in a checkpoint changes.
+*/
+typedef struct
+{
+    char magic[CHECKPOINT_MAGIC_SIZE];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t size;
+    uint64_t checksum;
+} CheckpointHeader;
+
+/*
+SECTION 4: FUNCTION PROTOTYPES
+*/
+char configureCheckpoint(const char *);
+char beginCheckpoint(void);
+char putCheckpoint(const void *, size_t);
+void commitCheckpoint(void);
+void closeCheckpoint(void);
+char loadCheckpoint(const char *);
+char getCheckpoint(void *, size_t);
+size_t checkpointLeft(void);
+void printCheckpointStats(void);
+
+#endif
@@ -7,6 +7,8 @@ SECTION 1A: C STANDARD LIBRARY
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <limits.h>
 
 /*
 SECTION 1B: SYSTEM CALL HEADER FILES
@@ -21,6 +23,21 @@ SECTION 1B: SYSTEM CALL HEADER FILES
 SECTION 1C: OTHER INCLUDES
 */
 #include <pcb.h>
+#include <jobs.h>
+#include <edf.h>
+#include <adapt.h>
+#include <event.h>
+#include <launch.h>
+#include <pool.h>
+#include <stress.h>
+#include <cgroup.h>
+#include <stats.h>
+#include <ingest.h>
+#include <reader.h>
+#include <window.h>
+#include <isolate.h>
+#include <fiber.h>
+#include <checkpoint.h>
 
 /*
 SECTION 2: VARIOUS MACROS
@@ -33,11 +50,16 @@ SECTION 2: VARIOUS MACROS
 #define TRUE 1
 #endif
 
-#define ARGS_JOBS_FILENAME 1
-#define ARGS_EXACT_COUNT 2
-#define JOBS_SPLIT_COUNT 3
+#define ARGS_EXACT_COUNT 1
+#define ARGS_OPTSTRING "raf:w:b:T:O:L:Z:S:X:C:P:J:MRKF:GW:AQ:BD:U:I:N:H:k:e:y:"
 #define UNIT_CPU_TIME_SIM 1
 
+#define ACCOUNT_TICKS 0
+#define ACCOUNT_CPU 1
+
+#define SETTINGS_COUNT 4
+#define SETTINGS_LINE_MAX 128
+
 /*
 SECTION 4: FUNCTION PROTOTYPES AND DEFINITIONS
 */
@@ -47,48 +69,614 @@ typedef struct
     uint64_t total_waiting;
     uint64_t total_response;
     uint64_t completed_jobs;
+
+    uint64_t deadline_jobs;
+    uint64_t deadline_misses;
+    uint64_t deadline_rejected;
+    uint64_t deadline_flagged;
+
+    uint64_t elided_switches;
+    uint64_t lost_jobs;
+    uint64_t deferred_launches;
+
+    uint64_t measured_jobs;
+    uint64_t measured_cpu_usec;
+
+    uint64_t running_ticks;
+    uint64_t charged_ns;
+
+    uint64_t cut_ticks;
+    uint64_t started_jobs;
+    uint64_t start_latency_ns;
+
+    uint64_t finished_jobs;
+    uint64_t responded_jobs;
+    uint64_t promotions;
+    uint64_t demotions;
+
+    uint64_t reloads;
+    uint64_t rejected_reloads;
 } Metrics;
 
 Metrics metrics;
 
+/*
+NOTE:
+    - How many jobs are in each level queue. It is kept up to date wherever a
+    job joins or leaves a level, so the depths can be reported without walk-
+    ing the queues.
+*/
+uint64_t level_depths[PCB_PRIORITY_2 + 1];
+
+/*
+NOTE:
+    - Where the scheduler keeps its state, so that it can be looked at from
+    outside the scheduling loop, such as by the stats endpoint. Everything
+    points into `main()`.
+*/
+typedef struct
+{
+    JobTable *jobs;
+    DeadlineHeap *edf;
+    Block **zero;
+    Block **one;
+    Block **two;
+    Block **current_process;
+    uint64_t *timer;
+    unsigned int *quanta[PCB_PRIORITY_2 + 1];
+    unsigned int *W;
+} Scheduler;
+
+Scheduler scheduler;
+
+/*
+NOTE:
+    - A process that has been taken off the CPU by the scheduler but not yet
+    actually stopped. Stopping it is put off until the next pick is known so
+    that the SIGTSTP/SIGCONT pair can be skipped if the same job is picked.
+*/
+Block *descheduled = NULL;
+
+/*
+NOTE:
+    - When the last tick was cut short by an arrival, the instant it was cut
+    at. The job dispatched then only had the rest of that tick.
+*/
+int64_t cut_at = 0;
+
+/*
+NOTE:
+    - Set when SIGHUP has come but the settings could not be reloaded yet,
+    because the tick it came in was cut short.
+*/
+char reload_pending = FALSE;
+
+/*
+NOTE:
+    - The tick the last checkpoint was taken at, or resumed from.
+*/
+uint64_t checkpointed_at = 0;
+
+/*
+NOTE:
+    - What a checkpoint holds. The scheduler comes first, then a block for
+    each job in the EDF heap, in heap order, and in levels 0, 1 and 2, each
+    level from its head. Last come the jobs still waiting in the JDQ. Every
+    count is in the scheduler image. Workloads are kept by name, as the
+    strings they point to are not the same from one run to the next.
+
+    - The metrics are kept as they are laid out in memory. The image starts
+    with its own size and that of `Metrics`, so a checkpoint taken by a
+    build where either differs is refused rather than misread.
+*/
+typedef struct
+{
+    uint32_t image_size;
+    uint32_t metrics_size;
+    uint64_t timer;
+    uint64_t taken;
+    unsigned int tick_ms;
+    unsigned int quanta[PCB_PRIORITY_2 + 1];
+    unsigned int W;
+    int reorder_depth;
+    uint32_t deadline_jobs;
+    uint32_t queued[PCB_PRIORITY_2 + 1];
+    uint32_t rows;
+    Metrics metrics;
+} SchedulerImage;
+
+typedef struct
+{
+    int arrival_time;
+    int deadline;
+    int remaining_cpu_time;
+    int last_queued;
+    int cycle_time;
+    int service_time;
+    int first_run;
+    int priority;
+    uint64_t carry_ns;
+    int64_t waited_ns;
+    char workload[JOBS_WORKLOAD_MAX];
+} BlockImage;
+
+typedef struct
+{
+    int arrival;
+    int64_t offset_ns;
+    int service;
+    int deadline;
+    int priority;
+    char workload[JOBS_WORKLOAD_MAX];
+    int held;
+} RowImage;
+
+typedef struct
+{
+    char *jobs_filename;
+    char reject_infeasible;
+
+    char adaptive;
+    double adapt_target;
+    int adapt_window;
+    unsigned int adapt_min;
+    unsigned int adapt_max;
+
+    unsigned int tick_ms;
+    unsigned int switch_timeout_ms;
+
+    int launch_method;
+    int pool_max;
+    int stress_count;
+    char block_stress;
+    int executor;
+    int accounting;
+
+    int dispatcher_cpu;
+    char *job_cpus;
+    char lock_memory;
+    char realtime;
+
+    char delegated;
+    int fiber_kernel;
+    char fiber_guard;
+
+    char *workload;
+    char preempt;
+    int reorder_depth;
+    char *stats_path;
+    char *ingest_fifo;
+    char *ingest_socket;
+    char *settings_path;
+    char *checkpoint_path;
+    unsigned int checkpoint_every;
+    char *restore_path;
+    int quarantine_after;
+} Options;
+
+Options options;
+
 /*
 DESCRIPTION:
-    - Reads the job dispatch queue from the jobs file and stores it in a queue.
+    - Prints the usage line for the dispatcher.
 
-RETURNS:
-    + Block* which is the head of a newly initialized queue.
-    + NULL if file is unable to be read.
+RETURN:
+    + Nothing.
 */
-Block *initializeJobDispatchQueue(char *filename)
+void printUsage(char *name)
 {
-    FILE *file = fopen(filename, "r");
+    fprintf(stderr, "USAGE: %s [-r] [-a] [-f <fraction>] [-w <window>] "
+                    "[-b <min>:<max>] [-T <tick_ms>] [-O <timeout_ms>] "
+                    "[-Q <timeouts>] [-L spawn|fork|fdexec] [-Z <workers>] "
+                    "[-X signal|cgroup|channel|fiber] [-F int|float] [-G] "
+                    "[-C ticks|cpu] [-P <cpu>] "
+                    "[-J <cpulist>] [-M] [-R] [-K] [-W <workload>] [-A] "
+                    "[-D <depth>] [-U <socket>] [-I <fifo>] [-N <socket>] "
+                    "[-H <settings>] [-k <checkpoint>] [-e <ticks>] "
+                    "[-y <checkpoint>] [<TESTFILE>]\n",
+            name);
+    fprintf(stderr, "       %s [-L spawn|fork|fdexec] [-X fiber] [-G] [-B] "
+                    "[-P <cpu>] [-J <cpulist>] [-M] [-R] -S <children>\n",
+            name);
+}
 
-    if (!file)
+/*
+DESCRIPTION:
+    - Parses the command line into the global `options`. Exactly one positio-
+    nal argument, the jobs file, must remain after the flags. It may be left
+    out when jobs are submitted at run time.
+
+        -r  Reject deadline jobs that fail the admission test. They are then
+            scheduled as ordinary jobs at their trace priority. Without this
+            flag they are admitted anyway and flagged as infeasible.
+        -a  Adaptive quanta. `t0`, `t1` and `t2` are only starting values and
+            are re-tuned from the jobs seen leaving each level.
+        -f  Target fraction of jobs that should finish in the level they are
+            in, between 0 and 1. Only used with `-a`.
+        -w  Number of recent jobs per level the adaptation looks at. Only
+            used with `-a`.
+        -b  Bounds every adapted quantum is clamped to, as `<min>:<max>`.
+            Only used with `-a`.
+        -T  Length of one time unit in milliseconds.
+        -O  Milliseconds a child gets to confirm a stop, continue or exit be-
+            fore the signal is escalated (SIGTSTP to SIGSTOP, SIGINT to SIG-
+            TERM to SIGKILL) or, with nothing left to escalate to, reported.
+        -Q  Quarantine a job once this many of its confirmations have timed
+            out. It is killed and dropped like a job that died on its own.
+        -L  How job processes are launched: `spawn` (posix_spawn, default),
+            `fork` (fork and execv) or `fdexec` (vfork and fexecve from a des-
+            criptor opened once at startup).
+        -Z  Keep up to this many launched and stopped workers warm, so that a
+            job's first dispatch is a single SIGCONT. The pool is sized from
+            the observed arrival rate.
+        -S  Stress mode. Instead of running a jobs file, grow a population of
+            this many stopped children and report per-operation latency as
+            it grows. The jobs file is not needed. With `-X fiber` the pop-
+            ulation is made of fibers instead.
+        -B  With `-S`, grow a population of queued blocks instead and report
+            the cost per job of walking a queue and of a starvation pass.
+        -X  How jobs are stopped and continued: `signal` (SIGTSTP/SIGCONT,
+            default) or `cgroup` (each job in its own cgroup v2 leaf, frozen
+            through `cgroup.freeze`). Falls back to signals if the cgroup
+            hierarchy is not writable. `channel` runs each job as a cooper-
+            ative worker that parks on a futex in shared memory when told
+            to. `fiber` runs each job as a coroutine inside the dispatcher,
+            burning CPU until the end of each tick.
+        -W  Default workload of `./process` for jobs that do not name one in
+            the jobs file: `sleep`, `spin`, `stream`, `chase` or `io`. It
+            is `spin` with `-C cpu` and `sleep` otherwise.
+        -F  CPU-burning kernel of the fibers: `int` (xorshift, default) or
+            `float` (square-root series).
+        -C  What a job is charged for each tick: `ticks` (one unit per tick
+            it was dispatched, default) or `cpu` (the CPU time it actually
+            consumed, read from the child). With `cpu` the workers spin in-
+            stead of sleeping so that they have something to be charged for.
+        -P  Pin the dispatcher to this CPU. Unless `-J` says otherwise, the
+            jobs then run on every other CPU.
+        -J  CPUs the jobs may run on, as a list such as `1-3,6`.
+        -M  Lock the dispatcher's memory so that it never faults on a tick.
+        -R  Run the dispatcher under SCHED_FIFO, if permitted. The jobs stay
+            in the normal class.
+        -K  Kernel-delegated mode. Every admitted job runs at once and its
+            level is expressed as a kernel priority, leaving the time slic-
+            ing to the kernel. Implies `-C cpu`.
+        -A  Arrival preemption. A job that arrives part of the way into a
+            tick and outranks the running job cuts the tick short and is
+            dispatched at once, instead of at the next tick.
+        -D  How many lines out of order a job may be in the jobs file and
+            still arrive on time (default 4096). 0 reads the whole file and
+            sorts it instead.
+        -U  Serve live stats on a Unix socket at this path. Each client that
+            connects is sent one snapshot of the queues and metrics.
+        -I  Take jobs submitted through a FIFO at this path, one per line in
+            the jobs file format. An arrival time of `now` arrives at the
+            next tick. The dispatcher then runs as a service until SIGTERM
+            or SIGINT, and the jobs file is optional.
+        -N  Same as `-I`, through a Unix socket listening at this path.
+        -H  Reload `t0`, `t1`, `t2` and `W` from the settings file at this
+            path on SIGHUP, without stopping. The new values apply from the
+            next whole tick.
+        -k  Take a checkpoint of the scheduler to a file at this path every
+            so many ticks, replacing the last one.
+        -e  Ticks between two checkpoints (default 60).
+        -y  Resume from the checkpoint at this path instead of starting
+            over. `t0`, `t1`, `t2` and `W` are taken from it rather than
+            asked for. The jobs file and `-D` must be the same as before.
+
+RETURN:
+    + TRUE if the arguments were valid.
+    + FALSE if not, after printing the usage line.
+*/
+char parseArguments(int argc, char *argv[])
+{
+    Block *probe;
+    char tuned = FALSE;
+    int opt;
+
+    options.jobs_filename = NULL;
+    options.reject_infeasible = FALSE;
+    options.adaptive = FALSE;
+    options.adapt_target = ADAPT_DEFAULT_TARGET;
+    options.adapt_window = ADAPT_DEFAULT_WINDOW;
+    options.adapt_min = ADAPT_DEFAULT_MIN;
+    options.adapt_max = ADAPT_DEFAULT_MAX;
+    options.tick_ms = UNIT_CPU_TIME_SIM * 1000;
+    options.switch_timeout_ms = EVENT_DEFAULT_TIMEOUT_MS;
+    options.launch_method = SPAWN_POSIX;
+    options.pool_max = 0;
+    options.stress_count = 0;
+    options.block_stress = FALSE;
+    options.executor = PCB_EXEC_SIGNAL;
+    options.accounting = ACCOUNT_TICKS;
+    options.dispatcher_cpu = ISOLATE_NO_CPU;
+    options.job_cpus = NULL;
+    options.lock_memory = FALSE;
+    options.realtime = FALSE;
+    options.delegated = FALSE;
+    options.fiber_kernel = FIBER_KERNEL_INT;
+    options.fiber_guard = FALSE;
+    options.workload = NULL;
+    options.preempt = FALSE;
+    options.reorder_depth = JOBS_DEFAULT_REORDER;
+    options.stats_path = NULL;
+    options.ingest_fifo = NULL;
+    options.ingest_socket = NULL;
+    options.settings_path = NULL;
+    options.checkpoint_path = NULL;
+    options.checkpoint_every = CHECKPOINT_DEFAULT_EVERY;
+    options.restore_path = NULL;
+    options.quarantine_after = EVENT_NO_QUARANTINE;
+
+    while ((opt = getopt(argc, argv, ARGS_OPTSTRING)) != -1)
     {
-        return NULL;
+        switch (opt)
+        {
+        case 'r':
+            options.reject_infeasible = TRUE;
+            break;
+        case 'a':
+            options.adaptive = TRUE;
+            break;
+        case 'f':
+            options.adapt_target = atof(optarg);
+            tuned = TRUE;
+            break;
+        case 'w':
+            options.adapt_window = atoi(optarg);
+            tuned = TRUE;
+            break;
+        case 'b':
+            tuned = TRUE;
+            if (sscanf(optarg, "%u:%u", &options.adapt_min,
+                       &options.adapt_max) != 2)
+            {
+                printUsage(argv[0]);
+                return FALSE;
+            }
+            break;
+        case 'T':
+            if ((options.tick_ms = (unsigned int)atoi(optarg)) == 0)
+            {
+                printUsage(argv[0]);
+                return FALSE;
+            }
+            break;
+        case 'O':
+            options.switch_timeout_ms = (unsigned int)atoi(optarg);
+            break;
+        case 'Q':
+            if ((options.quarantine_after = atoi(optarg)) <= 0)
+            {
+                printUsage(argv[0]);
+                return FALSE;
+            }
+            break;
+        case 'L':
+            if (!strcmp(optarg, "spawn"))
+                options.launch_method = SPAWN_POSIX;
+            else if (!strcmp(optarg, "fork"))
+                options.launch_method = SPAWN_FORK;
+            else if (!strcmp(optarg, "fdexec"))
+                options.launch_method = SPAWN_FDEXEC;
+            else
+            {
+                printUsage(argv[0]);
+                return FALSE;
+            }
+            break;
+        case 'Z':
+            options.pool_max = atoi(optarg);
+            break;
+        case 'S':
+            options.stress_count = atoi(optarg);
+            break;
+        case 'B':
+            options.block_stress = TRUE;
+            break;
+        case 'P':
+            if ((options.dispatcher_cpu = atoi(optarg)) < 0)
+            {
+                printUsage(argv[0]);
+                return FALSE;
+            }
+            break;
+        case 'J':
+            options.job_cpus = optarg;
+            break;
+        case 'M':
+            options.lock_memory = TRUE;
+            break;
+        case 'R':
+            options.realtime = TRUE;
+            break;
+        case 'K':
+            options.delegated = TRUE;
+            break;
+        case 'W':
+            options.workload = optarg;
+            break;
+        case 'A':
+            options.preempt = TRUE;
+            break;
+        case 'U':
+            options.stats_path = optarg;
+            break;
+        case 'I':
+            options.ingest_fifo = optarg;
+            break;
+        case 'N':
+            options.ingest_socket = optarg;
+            break;
+        case 'H':
+            options.settings_path = optarg;
+            break;
+        case 'k':
+            options.checkpoint_path = optarg;
+            break;
+        case 'e':
+            if ((options.checkpoint_every = (unsigned int)atoi(optarg)) == 0)
+            {
+                printUsage(argv[0]);
+                return FALSE;
+            }
+            break;
+        case 'y':
+            options.restore_path = optarg;
+            break;
+        case 'D':
+            if ((options.reorder_depth = atoi(optarg)) < JOBS_NO_REORDER)
+            {
+                printUsage(argv[0]);
+                return FALSE;
+            }
+            break;
+        case 'F':
+            if (!strcmp(optarg, "int"))
+                options.fiber_kernel = FIBER_KERNEL_INT;
+            else if (!strcmp(optarg, "float"))
+                options.fiber_kernel = FIBER_KERNEL_FLOAT;
+            else
+            {
+                printUsage(argv[0]);
+                return FALSE;
+            }
+            break;
+        case 'G':
+            options.fiber_guard = TRUE;
+            break;
+        case 'C':
+            if (!strcmp(optarg, "ticks"))
+                options.accounting = ACCOUNT_TICKS;
+            else if (!strcmp(optarg, "cpu"))
+                options.accounting = ACCOUNT_CPU;
+            else
+            {
+                printUsage(argv[0]);
+                return FALSE;
+            }
+            break;
+        case 'X':
+            if (!strcmp(optarg, "signal"))
+                options.executor = PCB_EXEC_SIGNAL;
+            else if (!strcmp(optarg, "cgroup"))
+                options.executor = PCB_EXEC_CGROUP;
+            else if (!strcmp(optarg, "channel"))
+                options.executor = PCB_EXEC_CHANNEL;
+            else if (!strcmp(optarg, "fiber"))
+                options.executor = PCB_EXEC_FIBER;
+            else
+            {
+                printUsage(argv[0]);
+                return FALSE;
+            }
+            break;
+        default:
+            printUsage(argv[0]);
+            return FALSE;
+        }
     }
 
-    Block *jobs = NULL;
-    Block *process = NULL;
-    while (!feof(file))
+    /*
+    NOTE:
+        - The target, window and bounds only steer the adaptation, so giving
+        them without it is taken for a mistake rather than ignored.
+    */
+    if (tuned && !options.adaptive)
     {
-        process = createNullBlock();
+        fprintf(stderr, "ERROR: -f, -w and -b can only be used with -a\n");
+        return FALSE;
+    }
 
-        /*
-        NOTE:
-            - Read in the arguments and if the arguments don't match then we
-            have a problem. Free the block and go to the next input.
-        */
-        if (fscanf(file, "%d, %d, %d", &(process->arrival_time),
-                   &(process->service_time), &(process->priority)) != JOBS_SPLIT_COUNT)
+    /*
+    NOTE:
+        - With every job running at once, a tick says nothing about who got
+        the CPU, so only the consumed time can be charged.
+    */
+    if (options.delegated)
+    {
+        if (options.preempt)
         {
-            free(process);
-            continue;
+            fprintf(stderr, "ERROR: -A cannot be used with -K\n");
+            return FALSE;
+        }
+        options.accounting = ACCOUNT_CPU;
+    }
+
+    /*
+    NOTE:
+        - A sleeping job consumes next to no CPU, so it would never finish
+        if it were charged for what it actually used.
+    */
+    if (!options.workload)
+    {
+        options.workload = options.accounting == ACCOUNT_CPU
+                               ? PCB_WORKLOAD_SPIN
+                               : PCB_WORKLOAD_SLEEP;
+    }
+    if ((probe = createNullBlock()) && !setWorkload(probe, options.workload))
+    {
+        fprintf(stderr, "ERROR: Unknown workload \"%s\"\n", options.workload);
+        freeBlock(probe);
+        return FALSE;
+    }
+    freeBlock(probe);
+
+    /*
+    NOTE:
+        - Fibers only run while the dispatcher runs them, one at a time, so
+        they cannot be handed to the kernel. Nor can a pool of processes be
+        of any use to them.
+    */
+    if (options.executor == PCB_EXEC_FIBER)
+    {
+        if (options.delegated)
+        {
+            fprintf(stderr, "ERROR: -K cannot be used with -X fiber\n");
+            return FALSE;
         }
-        process->remaining_cpu_time = process->service_time;
-        process->status = PCB_INITIALIZED;
+        options.pool_max = 0;
+    }
+
+    if (options.stress_count > 0 && argc == optind)
+        return TRUE;
+    if ((options.ingest_fifo || options.ingest_socket) && argc == optind)
+        return TRUE;
+
+    if (argc - optind != ARGS_EXACT_COUNT)
+    {
+        printUsage(argv[0]);
+        return FALSE;
+    }
+    options.jobs_filename = argv[optind];
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Creates the job dispatch queue, an empty job table sorted by arrival,
+    and starts the reader that fills it from the jobs file as the jobs come
+    due. Blocks are only created for the jobs as they arrive. Lines that
+    cannot be turned into a job are quarantined and left out. With no jobs
+    file the table only takes jobs submitted at run time.
+
+RETURNS:
+    + JobTable* of the newly created table.
+    + NULL if file is unable to be read.
+*/
+JobTable *initializeJobDispatchQueue(char *filename)
+{
+    JobTable *jobs;
+
+    if (!(jobs = createJobTable(JOBS_NO_REORDER)))
+        return NULL;
 
-        jobs = enqueueBlock(jobs, process);
+    if (filename &&
+        !openReader(filename, options.reorder_depth,
+                    (int64_t)options.tick_ms * EVENT_NANOS_PER_MILLI,
+                    options.workload))
+    {
+        return NULL;
     }
 
     return jobs;
@@ -96,20 +684,20 @@ Block *initializeJobDispatchQueue(char *filename)
 
 /*
 DESCRIPTION:
-    - Counts the total number of jobs by traversing through the linked list
-    recursively.
+    - Counts the total number of jobs by traversing through the linked list.
+    Only the blocks themselves are read, never their side table.
 
 RETURNS:
     + The total number of jobs
 */
 uint64_t countTotalJobs(Block *head)
 {
-    if (!head)
-    {
-        return 0;
-    }
+    uint64_t count = 0;
 
-    return 1 + countTotalJobs(head->next);
+    for (; head; head = nextBlock(head))
+        count++;
+
+    return count;
 }
 
 /*
@@ -127,7 +715,7 @@ void printQueue(Block *head)
     while (current)
     {
         printBlock(current);
-        current = current->next;
+        current = nextBlock(current);
     }
 }
 
@@ -203,160 +791,351 @@ void getUserInput(unsigned int *t0, unsigned int *t1, unsigned int *t2,
     }
 }
 
-void queueFromDispatch(Block **jobs, Block **zero, Block **one, Block **two,
-                       uint64_t timer)
+/*
+DESCRIPTION:
+    - Reads new values of `t0`, `t1`, `t2` and `W` from the settings file at
+    `path`, one `<name> <value>` line each. Blank lines and lines starting
+    with `#` are skipped, and a name that is left out keeps its value. The
+    values are only changed if every line is valid, and then all together,
+    the same as `getUserInput()` checks them.
+
+RETURN:
+    + TRUE if the new values were applied.
+    + FALSE if the file could not be read or a line was not valid. Nothing
+    is changed then.
+*/
+char reloadSettings(const char *path, unsigned int *t0, unsigned int *t1,
+                    unsigned int *t2, unsigned int *W)
 {
-    /*
-    NOTE:
-        - Putting the first job in the JDQ where it belongs if it's time
-        for it to arrive.
-    */
-    while ((*jobs) && timer >= (*jobs)->arrival_time)
+    static const char *names[SETTINGS_COUNT] = {"t0", "t1", "t2", "W"};
+    unsigned int *targets[SETTINGS_COUNT] = {t0, t1, t2, W};
+    unsigned int values[SETTINGS_COUNT] = {*t0, *t1, *t2, *W};
+    char line[SETTINGS_LINE_MAX], name[SETTINGS_LINE_MAX], extra;
+    const char *reason = NULL;
+    long value;
+    int line_no = 0, i;
+    FILE *file = fopen(path, "r");
+
+    if (!file)
     {
-        /*
-        NOTE:
-            - When dequeueing blocks, we need to pass in the address of
-            the pointer `jobs`. This will effectively modify the value
-            of `jobs` itself. If there's nothing left in the queue, the
-            dequeue function will set `jobs` to NULL.
-        */
-        Block *dequeued = dequeueBlock(jobs);
-        dequeued->last_queued = timer;
-        switch (dequeued->priority)
+        fprintf(stderr, "WARNING: Could not read settings \"%s\": %s\n",
+                path, strerror(errno));
+        return FALSE;
+    }
+
+    while (!reason && fgets(line, sizeof(line), file))
+    {
+        line_no++;
+        if (line[strspn(line, " \t\r\n")] == '\0' ||
+            line[strspn(line, " \t")] == '#')
+            continue;
+
+        if (sscanf(line, "%s %ld %c", name, &value, &extra) != 2)
         {
-        case PCB_PRIORITY_0:
-            *zero = enqueueBlock(*zero, dequeued);
-            break;
-        case PCB_PRIORITY_1:
-            *one = enqueueBlock(*one, dequeued);
-            break;
-        case PCB_PRIORITY_2:
-            *two = enqueueBlock(*two, dequeued);
-            break;
-        default:
-            /*
-            NOTE:
-                - Re-enqueue if jobs cannot be categorized. Hopefully this
-                doesn't happen.
-            */
-            *jobs = enqueueBlock(*jobs, dequeued);
-            break;
+            reason = "not a name and a value";
+            continue;
         }
+        for (i = 0; i < SETTINGS_COUNT && strcmp(name, names[i]); i++)
+            ;
+        if (i == SETTINGS_COUNT)
+            reason = "an unknown setting";
+        else if (value <= 0 || value > UINT_MAX)
+            reason = "not a positive integer";
+        else
+            values[i] = (unsigned int)value;
+    }
+    fclose(file);
+
+    if (reason)
+    {
+        fprintf(stderr, "WARNING: Settings not reloaded, line %d of \"%s\" "
+                        "is %s\n",
+                line_no, path, reason);
+        return FALSE;
     }
+
+    for (i = 0; i < SETTINGS_COUNT; i++)
+        *targets[i] = values[i];
+
+    return TRUE;
 }
 
 /*
 DESCRIPTION:
-    - Compares `a` and `b` and returns whichever one is smaller.
+    - Offers a job with a deadline to the EDF class. The job is admitted if
+    the admission test passes. Otherwise it is either flagged and admitted
+    anyway or rejected, depending on `options.reject_infeasible`.
 
 RETURN:
-    + The smaller integer out of the two.
+    + TRUE if the job went into the deadline heap.
+    + FALSE if it was rejected and has to be queued by priority instead.
 */
-int min(int a, int b)
+char admitDeadlineJob(DeadlineHeap *edf, Block *process, uint64_t timer)
 {
-    return (a < b) ? a : b;
+    if (!isFeasibleWith(edf, process, timer))
+    {
+        if (options.reject_infeasible)
+        {
+            fprintf(stderr, "ALERT: Rejected job (arrival %d, deadline %d) "
+                            "from EDF class\n",
+                    process->arrival_time, process->deadline);
+            metrics.deadline_rejected++;
+            return FALSE;
+        }
+
+        fprintf(stderr, "ALERT: Admitted infeasible job (arrival %d, "
+                        "deadline %d)\n",
+                process->arrival_time, process->deadline);
+        metrics.deadline_flagged++;
+    }
+
+    return pushDeadline(edf, process) != NULL;
 }
 
 /*
 DESCRIPTION:
-    - Compares `a` and `b` and returns whichever one is greater.
+    - Finds the instant a job arrived, or is due to arrive, on the monotonic
+    clock. The job arrives `offset_ns` into tick `arrival`, and the tick the
+    dispatcher is in is taken to be `timer`.
 
 RETURN:
-    + The greater integer out of the two.
+    + The arrival instant in nanoseconds.
 */
-int max(int a, int b)
+int64_t arrivalNanos(int arrival, int64_t offset_ns, uint64_t timer)
 {
-    return (a > b) ? a : b;
+    int64_t tick = (int64_t)options.tick_ms * EVENT_NANOS_PER_MILLI;
+
+    return nextTickNanos() - ((int64_t)timer - arrival + 1) * tick +
+           offset_ns;
 }
 
 /*
 DESCRIPTION:
-    - Checks whether the current process exists. If not, it will take the first
-    element in the `queue` and run it. If the current process is not the one in
-    the current `queue` then we still run it anyway as we assume the order is
-    maintained.
+    - Moves every job whose arrival time has come from the JDQ into the queue
+    of its class. Jobs with a deadline go to the EDF heap if admitted, all
+    others go to the level queue matching their priority.
+
+    - Jobs still being read are first taken from the reader, up to the first
+    one that arrives after this tick. The JDQ is sorted by arrival, so the
+    jobs that have arrived are found with a binary search. A job that ar-
+    rives part of the way into the tick only counts once that instant has
+    passed. The batch is chained up per level and each chain is then joined
+    to its queue in one go.
 
 RETURN:
-    + Nothing. However, it does change the state of `current_process`. It switch-
-    es to something else.
+    + Nothing.
 */
-void checkAndRunProcess(Block **current_process, Block *queue, uint64_t timer)
+void queueFromDispatch(JobTable *jobs, DeadlineHeap *edf, Block **zero,
+                       Block **one, Block **two, uint64_t timer)
 {
-    if (!(*current_process))
+    Block **levels[] = {zero, one, two};
+    Block *heads[PCB_PRIORITY_2 + 1] = {NULL};
+    Block *tails[PCB_PRIORITY_2 + 1] = {NULL};
+    Block *dequeued;
+    int64_t into = monotonicNanos() - nextTickNanos() +
+                   (int64_t)options.tick_ms * EVENT_NANOS_PER_MILLI;
+    int64_t offset_ns;
+    int end, level;
+
+    if (into < 0)
+        into = 0;
+    metrics.completed_jobs += pullJobs(jobs, timer);
+    end = findArrivals(jobs, (int)timer, into);
+
+    while (jobs->next < end)
     {
-        /*
-        NOTE:
-            - If nothing, we just run normally.
-        */
-        (*current_process) = queue;
+        offset_ns = jobs->offset_ns[jobs->next];
+        if (!(dequeued = takeJob(jobs)))
+            break;
+        dequeued->last_queued = timer;
+        blockInfo(dequeued)->arrived_ns =
+            arrivalNanos(dequeued->arrival_time, offset_ns, timer);
+        noteArrival();
 
-        if ((*current_process)->status == PCB_INITIALIZED)
-        {
-            startBlock(*current_process);
-            metrics.total_response += (timer -
-                                       (*current_process)->arrival_time);
-        }
-        else
+        if (dequeued->deadline != PCB_NO_DEADLINE)
         {
-            resumeBlock(*current_process);
+            metrics.deadline_jobs++;
+            if (admitDeadlineJob(edf, dequeued, timer))
+                continue;
         }
-    }
-    else if ((*current_process) != queue)
-    {
+
         /*
         NOTE:
-            - If the `current_process` is not the first process in the current
-            `queue` then we suspend the currently running process.
-
-            -  This function would always take greater precedence (that's the
-            assumption, at least).
+            - Priorities were checked when the jobs file was read, so every
+            job has a level to go to.
         */
-        suspendBlock(*current_process);
-        *current_process = queue;
-
-        if ((*current_process)->status == PCB_INITIALIZED)
-        {
-            startBlock(*current_process);
-            metrics.total_response += (timer -
-                                       (*current_process)->arrival_time);
-        }
+        level = dequeued->priority;
+        if (tails[level])
+            tails[level]->next = dequeued->id;
         else
-        {
-            resumeBlock(*current_process);
-        }
+            heads[level] = dequeued;
+        tails[level] = dequeued;
+        level_depths[level]++;
     }
+
+    for (level = PCB_PRIORITY_0; level <= PCB_PRIORITY_2; level++)
+        *levels[level] = appendQueue(*levels[level], heads[level]);
 }
 
 /*
 DESCRIPTION:
-    - Checks whether the currently running process has reached its time quantum.
-    Demote if it has, and does all these menial dequeue and enqueue stuff.
-
-    - The parameter `from` is the queue to dequeue from and `to` is the queue to
-    enqueue to.
+    - Compares `a` and `b` and returns whichever one is smaller.
 
 RETURN:
-    + TRUE if has equalled or exceeded the time quantum.
-    + FALSE if not the case.
+    + The smaller integer out of the two.
 */
-char checkAndDemote(Block **current_process, int quantum, Block **from, Block **to,
-                    int new_priority, uint64_t timer)
+int min(int a, int b)
 {
-    if ((*current_process)->cycle_time >= quantum)
-    {
-        (*current_process)->priority = new_priority;
+    return (a < b) ? a : b;
+}
+
+/*
+DESCRIPTION:
+    - Compares `a` and `b` and returns whichever one is greater.
+
+RETURN:
+    + The greater integer out of the two.
+*/
+int max(int a, int b)
+{
+    return (a > b) ? a : b;
+}
+
+/*
+DESCRIPTION:
+    - Puts `p` on the CPU. A process that was only descheduled is stopped here,
+    now that we know the next pick. If the next pick is that very process the
+    stop and the continue are both skipped and it simply keeps running.
+
+    - A first launch that hits the process limit is deferred. The block stays
+    initialized and does not run this tick. A launch that goes through is
+    timed from the instant the job arrived. A job resumed from a checkpoint
+    is launched again, but keeps the first run it had.
+
+RETURN:
+    + Nothing.
+*/
+void dispatchBlock(Block *p, uint64_t timer)
+{
+    if (descheduled)
+    {
+        if (descheduled == p)
+        {
+            descheduled = NULL;
+            metrics.elided_switches++;
+            return;
+        }
+
+        suspendBlock(descheduled);
+        descheduled = NULL;
+    }
+
+    if (p->status == PCB_INITIALIZED)
+    {
+        if (!startBlock(p))
+        {
+            metrics.deferred_launches++;
+            return;
+        }
+        if (blockInfo(p)->first_run == PCB_NOT_RUN)
+        {
+            blockInfo(p)->first_run = (int)timer;
+            metrics.started_jobs++;
+            metrics.start_latency_ns +=
+                monotonicNanos() - blockInfo(p)->arrived_ns;
+        }
+    }
+    else
+    {
+        resumeBlock(p);
+    }
+}
+
+/*
+DESCRIPTION:
+    - Checks whether the current process exists. If not, it will take the first
+    element in the `queue` and run it. If the current process is not the one in
+    the current `queue` then we still run it anyway as we assume the order is
+    maintained.
+
+RETURN:
+    + Nothing. However, it does change the state of `current_process`. It switch-
+    es to something else.
+*/
+void checkAndRunProcess(Block **current_process, Block *queue, uint64_t timer)
+{
+    if (!(*current_process))
+    {
+        /*
+        NOTE:
+            - If nothing, we just run normally.
+        */
+        (*current_process) = queue;
+        dispatchBlock(*current_process, timer);
+    }
+    else if ((*current_process) != queue)
+    {
+        /*
+        NOTE:
+            - If the `current_process` is not the first process in the current
+            `queue` then we suspend the currently running process.
+
+            -  This function would always take greater precedence (that's the
+            assumption, at least).
+        */
+        suspendBlock(*current_process);
+        *current_process = queue;
+        dispatchBlock(*current_process, timer);
+    }
+    else if ((*current_process)->status == PCB_INITIALIZED)
+    {
+        /*
+        NOTE:
+            - The launch was deferred at the process limit last time round,
+            so it is tried again.
+        */
+        dispatchBlock(*current_process, timer);
+    }
+}
+
+/*
+DESCRIPTION:
+    - Checks whether the currently running process has reached its time quantum.
+    Demote if it has, and does all these menial dequeue and enqueue stuff.
+
+    - The parameter `from` is the queue to dequeue from and `to` is the queue to
+    enqueue to.
+
+RETURN:
+    + TRUE if has equalled or exceeded the time quantum.
+    + FALSE if not the case.
+*/
+char checkAndDemote(Block **current_process, int quantum, Block **from, Block **to,
+                    int new_priority, uint64_t timer)
+{
+    if ((*current_process)->cycle_time >= quantum)
+    {
+        if (options.adaptive)
+            observeExit((*current_process)->priority, FALSE,
+                        (*current_process)->cycle_time);
+        level_depths[(*current_process)->priority]--;
+        level_depths[new_priority]++;
+        (*current_process)->priority = new_priority;
 
         /*
         NOTE:
             - Resetting the cycle clock and doing all the dequeueing and enque-
-            ueing while suspending the process.
+            ueing. The process is only descheduled here, it is stopped once
+            the next pick is known to be a different job.
         */
         (*current_process)->cycle_time = 0;
 
-        suspendBlock(*current_process);
+        descheduled = *current_process;
         Block *dequeued = dequeueBlock(from);
         dequeued->last_queued = timer;
         *to = enqueueBlock(*to, dequeued);
+        metrics.demotions++;
+        noteLevelMoves(timer, 0, 1);
 
         *current_process = NULL;
 
@@ -366,6 +1145,52 @@ char checkAndDemote(Block **current_process, int quantum, Block **from, Block **
     return FALSE;
 }
 
+/*
+DESCRIPTION:
+    - Adds a finished job to the running metric sums and to the rolling win-
+    dows. Jobs that carried a deadline also have their slack recorded, which-
+    ever class ran them. Waiting time is what is left of the turnaround af-
+    ter the CPU time the job was charged, which is more than its service
+    time when the last charge overshot. A job that finished without ever
+    being run has no response time, and is left out of that average.
+
+RETURN:
+    + Nothing.
+*/
+void recordCompletion(Block *process, uint64_t timer)
+{
+    BlockInfo *info = blockInfo(process);
+    uint64_t turnaround = timer - process->arrival_time;
+    uint64_t waiting = turnaround - (info->service_time -
+                                     process->remaining_cpu_time);
+    uint64_t response = WINDOW_NO_RESPONSE;
+
+    if (info->first_run != PCB_NOT_RUN)
+    {
+        response = info->first_run - process->arrival_time;
+        metrics.responded_jobs++;
+        metrics.total_response += response;
+    }
+    metrics.finished_jobs++;
+    metrics.total_turnaround += turnaround;
+    metrics.total_waiting += waiting;
+    noteFinished(turnaround, waiting, response);
+
+    if (info->in_cgroup)
+    {
+        metrics.measured_jobs++;
+        metrics.measured_cpu_usec += info->cpu_usec;
+    }
+
+    if (process->deadline != PCB_NO_DEADLINE)
+    {
+        int slack = process->deadline - (int)timer;
+        if (slack < 0)
+            metrics.deadline_misses++;
+        recordSlack(slack);
+    }
+}
+
 /*
 DESCRIPTION:
     - Checks whether the currently running process has completed. We terminate
@@ -379,18 +1204,49 @@ char checkAndTerminate(Block **current_process, Block **from, uint64_t timer)
 {
     if ((*current_process)->remaining_cpu_time <= 0)
     {
+        if (options.adaptive)
+            observeExit((*current_process)->priority, TRUE,
+                        (*current_process)->cycle_time);
+
         Block *dequeued = dequeueBlock(from);
-        metrics.total_turnaround += (timer - dequeued->arrival_time);
-        metrics.total_waiting += (timer - dequeued->arrival_time -
-                                  dequeued->service_time);
+        level_depths[dequeued->priority]--;
         terminateBlock(*current_process);
+        recordCompletion(dequeued, timer);
 
         /*
         NOTE:
             - Freeing to avoid memory leaks and making the pointer to the curr-
             ently running process NULL because that's good practice.
         */
-        free(*current_process);
+        freeBlock(*current_process);
+        *current_process = NULL;
+
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*
+DESCRIPTION:
+    - Same as `checkAndTerminate()` but for the EDF class. The running job is
+    always the top of the deadline heap here, since new arrivals are only
+    pushed after this check.
+
+RETURN:
+    + TRUE if job has finished.
+    + FALSE if not the case.
+*/
+char checkAndTerminateDeadline(Block **current_process, DeadlineHeap *edf,
+                               uint64_t timer)
+{
+    if ((*current_process)->remaining_cpu_time <= 0)
+    {
+        Block *popped = popDeadline(edf);
+        terminateBlock(*current_process);
+        recordCompletion(popped, timer);
+
+        freeBlock(*current_process);
         *current_process = NULL;
 
         return TRUE;
@@ -399,6 +1255,36 @@ char checkAndTerminate(Block **current_process, Block **from, uint64_t timer)
     return FALSE;
 }
 
+/*
+DESCRIPTION:
+    - Moves every job in queue `from` to the end of level-0 queue `zero`. The
+    jobs are reset in one pass over their blocks and the queue is then joined
+    to `zero` as a whole.
+
+RETURNS:
+    + Nothing.
+*/
+void promoteQueue(Block **from, Block **zero, uint64_t timer)
+{
+    Block *process;
+    int promoted = 0;
+
+    for (process = *from; process; process = nextBlock(process))
+    {
+        level_depths[process->priority]--;
+        process->cycle_time = 0;
+        process->priority = PCB_PRIORITY_0;
+        process->last_queued = timer;
+        promoted++;
+    }
+    level_depths[PCB_PRIORITY_0] += promoted;
+    metrics.promotions += promoted;
+    noteLevelMoves(timer, promoted, 0);
+
+    *zero = appendQueue(*zero, *from);
+    *from = NULL;
+}
+
 /*
 DESCRIPTION:
     - Checks for starvation using last_queued timestamp and promotes processes
@@ -422,27 +1308,13 @@ void checkAndHandleStarvation(Block **zero, Block **one, Block **two,
         NOTE:
             - Moving all level-1 queue jobs.
         */
-        while (*one)
-        {
-            Block *process = dequeueBlock(one);
-            process->cycle_time = 0;
-            process->priority = PCB_PRIORITY_0;
-            process->last_queued = timer;
-            *zero = enqueueBlock(*zero, process);
-        }
+        promoteQueue(one, zero, timer);
 
         /*
         NOTE:
             - Moving all level-2 queue jobs.
         */
-        while (*two)
-        {
-            Block *process = dequeueBlock(two);
-            process->cycle_time = 0;
-            process->priority = PCB_PRIORITY_0;
-            process->last_queued = timer;
-            *zero = enqueueBlock(*zero, process);
-        }
+        promoteQueue(two, zero, timer);
     }
     /*
     NOTE:
@@ -454,33 +1326,908 @@ void checkAndHandleStarvation(Block **zero, Block **one, Block **two,
         NOTE:
             - Moving level-2 queue jobs.
         */
-        while (*two)
+        promoteQueue(two, zero, timer);
+    }
+}
+
+/*
+DESCRIPTION:
+    - Takes every job whose process died on its own, or was quarantined, out
+    of its queue and frees it. Its cgroup leaf and channel slot are retired
+    like those of a job that finished. The job no longer counts towards the
+    averages.
+
+RETURN:
+    + Nothing. However, `current_process` is cleared if it was one of them.
+*/
+void reapLostJobs(Block **current_process, DeadlineHeap *edf, Block **zero,
+                  Block **one, Block **two)
+{
+    Block *lost;
+
+    while ((lost = collectLostChild()))
+    {
+        if (!removeDeadline(edf, lost) &&
+            (removeBlock(zero, lost) || removeBlock(one, lost) ||
+             removeBlock(two, lost)))
         {
-            Block *process = dequeueBlock(two);
-            process->cycle_time = 0;
-            process->priority = PCB_PRIORITY_0;
-            process->last_queued = timer;
-            *zero = enqueueBlock(*zero, process);
+            level_depths[lost->priority]--;
         }
+
+        if (*current_process == lost)
+            *current_process = NULL;
+        if (descheduled == lost)
+            descheduled = NULL;
+
+        if (blockInfo(lost)->in_cgroup)
+            retireCgroup(blockInfo(lost)->pid);
+        if (blockInfo(lost)->slot != CHANNEL_NO_SLOT)
+            exitSlot(blockInfo(lost)->slot);
+
+        metrics.lost_jobs++;
+        metrics.completed_jobs--;
+        freeBlock(lost);
+    }
+}
+
+/*
+DESCRIPTION:
+    - Charges block `p` for `ns` nanoseconds of time. Time is charged in whole
+    units of one tick, and whatever is left over is carried to the next
+    charge.
+
+RETURN:
+    + Nothing.
+*/
+void chargeTime(Block *p, uint64_t ns)
+{
+    uint64_t unit = (uint64_t)options.tick_ms * 1000000;
+    BlockInfo *info = blockInfo(p);
+    int units;
+
+    info->carry_ns += ns;
+    units = (int)(info->carry_ns / unit);
+    info->carry_ns -= (uint64_t)units * unit;
+    p->cycle_time += units;
+    p->remaining_cpu_time -= units;
+}
+
+/*
+DESCRIPTION:
+    - Charges block `p` for the CPU time its process consumed since it was
+    last sampled. Anything consumed while it was being stopped is picked up
+    by the sample after it next runs.
+
+RETURN:
+    + Nothing.
+*/
+void chargeCpu(Block *p)
+{
+    uint64_t sample = sampleBlockCpu(p), used = 0;
+    BlockInfo *info = blockInfo(p);
+
+    if (sample > info->cpu_ns)
+    {
+        used = sample - info->cpu_ns;
+        info->cpu_ns = sample;
+    }
+
+    metrics.charged_ns += used;
+    chargeTime(p, used);
+}
+
+/*
+DESCRIPTION:
+    - Checks whether the job in row `i` of the JDQ would take the CPU from
+    the running job `q`, or from nobody if `q` is NULL. Deadline jobs go be-
+    fore all others and among themselves by deadline. Other jobs go by level.
+
+RETURN:
+    + TRUE if the job outranks `q`.
+    + FALSE otherwise.
+*/
+char outranks(JobTable *jobs, int i, Block *q)
+{
+    if (!q)
+        return TRUE;
+    if (jobs->deadline[i] != PCB_NO_DEADLINE)
+        return q->deadline == PCB_NO_DEADLINE || jobs->deadline[i] < q->deadline;
+
+    return q->deadline == PCB_NO_DEADLINE && jobs->priority[i] < q->priority;
+}
+
+/*
+DESCRIPTION:
+    - With arrival preemption on, arms the arrival timer for the first job in
+    the JDQ that arrives later in tick `timer` and outranks `current`.
+
+RETURN:
+    + The instant the timer was armed for.
+    + Zero if it was not armed.
+*/
+int64_t armPreemption(JobTable *jobs, Block *current, uint64_t timer)
+{
+    int64_t at;
+    int i;
+
+    if (!options.preempt)
+        return 0;
+
+    for (i = jobs->next;
+         i < jobs->count && (uint64_t)jobs->arrival[i] == timer; i++)
+    {
+        if (!jobs->offset_ns[i] || !outranks(jobs, i, current))
+            continue;
+
+        at = arrivalNanos(jobs->arrival[i], jobs->offset_ns[i], timer);
+        armArrival(at);
+        return at;
     }
+
+    return 0;
 }
 
 /*
 DESCRIPTION:
     - Simulates a CPU cycle. Updates the timer and pretend to sleep for a CPU
     cycle. Also updates the current process's allotted cycle time and its re-
-    quired remaining time.
+    quired remaining time. A fiber is run by the dispatcher for the tick in-
+    stead of sleeping through it.
+
+    - With arrival preemption on, a job in `jobs` that arrives during the tick
+    and outranks the current process ends the cycle at its arrival instant.
+    The timer then stays where it is and the current process is charged for
+    the part of the tick it had. The same goes for a process that was only
+    dispatched when the tick had already been cut. Parts of a tick are car-
+    ried until they add up to a whole unit.
 
 RETURN:
     + Nothing. But the pointer arguments passed into the function does change
     their states.
 */
-void updateCycle(Block **current_process, uint64_t *timer)
+void updateCycle(Block **current_process, JobTable *jobs, uint64_t *timer)
 {
-    sleep(UNIT_CPU_TIME_SIM);
+    int64_t due = nextTickNanos();
+    int64_t start = due - (int64_t)options.tick_ms * EVENT_NANOS_PER_MILLI;
+    int64_t at = armPreemption(jobs, *current_process, *timer);
+
+    if (cut_at > start)
+        start = cut_at;
+
+    runBlock(*current_process, at ? at : due);
+    if (!awaitSlice())
+    {
+        cut_at = at;
+        metrics.cut_ticks++;
+        if ((*current_process)->status != PCB_RUNNING)
+            return;
+
+        if (options.accounting == ACCOUNT_CPU)
+            chargeCpu(*current_process);
+        else
+            chargeTime(*current_process, (uint64_t)(at - start));
+        return;
+    }
     (*timer)++;
 
+    /*
+    NOTE:
+        - The process may have died during the tick, in which case it is
+        taken out of its queue by `reapLostJobs()` on the next pass. Or its
+        launch may have been deferred. Either way it did not run.
+    */
+    if ((*current_process)->status != PCB_RUNNING)
+        return;
+
+    metrics.running_ticks++;
+    if (options.accounting == ACCOUNT_CPU)
+    {
+        chargeCpu(*current_process);
+        return;
+    }
+    if (start > due - (int64_t)options.tick_ms * EVENT_NANOS_PER_MILLI ||
+        blockInfo(*current_process)->carry_ns)
+    {
+        chargeTime(*current_process, (uint64_t)(due - start));
+        return;
+    }
+
     (*current_process)->cycle_time++;
     (*current_process)->remaining_cpu_time--;
 }
+
+/*
+DESCRIPTION:
+    - Idles through a CPU cycle while no job is queued, then updates the
+    timer. With arrival preemption on, the cycle ends early when a job in
+    `jobs` arrives during the tick, and the timer stays where it is.
+
+RETURN:
+    + Nothing.
+*/
+void idleCycle(JobTable *jobs, uint64_t *timer)
+{
+    int64_t at = armPreemption(jobs, NULL, *timer);
+
+    if (!awaitSlice())
+    {
+        cut_at = at;
+        return;
+    }
+    (*timer)++;
+}
+
+/*
+DESCRIPTION:
+    - Terminates and frees every job in `queue` that has consumed its service
+    time, and moves every other job that has used up `quantum` to `to` at le-
+    vel `level`. A NULL `to` means the jobs stay where they are.
+
+RETURN:
+    + Nothing.
+*/
+void delegateQueue(Block **queue, unsigned int quantum, Block **to, int level,
+                   uint64_t timer)
+{
+    Block *prev = NULL, *process, *next;
+
+    for (process = *queue; process; process = next)
+    {
+        next = nextBlock(process);
+
+        if (process->remaining_cpu_time <= 0)
+        {
+            unlinkBlock(queue, prev, process);
+            level_depths[process->priority]--;
+            terminateBlock(process);
+            recordCompletion(process, timer);
+            freeBlock(process);
+            continue;
+        }
+
+        if (to && process->cycle_time >= (int)quantum)
+        {
+            unlinkBlock(queue, prev, process);
+            level_depths[process->priority]--;
+            level_depths[level]++;
+            process->cycle_time = 0;
+            process->priority = level;
+            process->last_queued = timer;
+            *to = enqueueBlock(*to, process);
+            metrics.demotions++;
+            noteLevelMoves(timer, 0, 1);
+            continue;
+        }
+
+        prev = process;
+    }
+}
+
+/*
+DESCRIPTION:
+    - Starts job `p` if it has not been launched yet and gives it the kernel
+    priority of level `level`.
+
+RETURN:
+    + Nothing.
+*/
+void startDelegated(Block *p, int level, uint64_t timer)
+{
+    if (p->status == PCB_INITIALIZED)
+    {
+        if (!startBlock(p))
+        {
+            metrics.deferred_launches++;
+            return;
+        }
+        if (blockInfo(p)->first_run == PCB_NOT_RUN)
+            blockInfo(p)->first_run = (int)timer;
+    }
+    prioritizeBlock(p, level);
+}
+
+/*
+DESCRIPTION:
+    - Same as `startDelegated()` for every job in `queue`.
+
+RETURN:
+    + Nothing.
+*/
+void startQueue(Block *queue, int level, uint64_t timer)
+{
+    for (; queue; queue = nextBlock(queue))
+        startDelegated(queue, level, timer);
+}
+
+/*
+DESCRIPTION:
+    - Charges every running job in `queue` for the CPU it consumed.
+
+RETURN:
+    + Nothing.
+*/
+void chargeQueue(Block *queue)
+{
+    for (; queue; queue = nextBlock(queue))
+    {
+        if (queue->status == PCB_RUNNING)
+            chargeCpu(queue);
+    }
+}
+
+/*
+DESCRIPTION:
+    - One tick of the kernel-delegated mode. Every admitted job runs at once
+    and the queue levels only decide the kernel priority it runs at. Deadline
+    jobs are given the priority of level 0. Demotion and starvation promotion
+    still move jobs between queues as usual, and take effect as a priority
+    change on the next tick.
+
+RETURN:
+    + TRUE if there is still work left, or jobs may still be submitted.
+    + FALSE once every job has finished.
+*/
+char delegateTick(JobTable *jobs, DeadlineHeap *edf, Block **zero, Block **one,
+                  Block **two, unsigned int t0, unsigned int t1,
+                  unsigned int W, uint64_t *timer)
+{
+    Block *process, *finished = NULL;
+    int i;
+
+    if (pendingJobs(jobs))
+        queueFromDispatch(jobs, edf, zero, one, two, *timer);
+
+    if (!peekDeadline(edf) && !*zero && !*one && !*two)
+    {
+        if (!pendingJobs(jobs) && !isIngestOpen())
+            return FALSE;
+
+        (*timer)++;
+        awaitTick();
+        return TRUE;
+    }
+
+    /*
+    NOTE:
+        - Deadline jobs are not given a quantum here either, they are kept
+        boosted until they finish.
+    */
+    for (i = 0; i < edf->size; i++)
+        startDelegated(edf->heap[i], PCB_PRIORITY_0, *timer);
+    startQueue(*zero, PCB_PRIORITY_0, *timer);
+    startQueue(*one, PCB_PRIORITY_1, *timer);
+    startQueue(*two, PCB_PRIORITY_2, *timer);
+
+    awaitTick();
+    (*timer)++;
+    metrics.running_ticks++;
+
+    for (i = 0; i < edf->size; i++)
+    {
+        if (edf->heap[i]->status == PCB_RUNNING)
+            chargeCpu(edf->heap[i]);
+    }
+    chargeQueue(*zero);
+    chargeQueue(*one);
+    chargeQueue(*two);
+
+    /*
+    NOTE:
+        - Finished deadline jobs are chained up before any is removed, as a
+        removal reorders the heap under the scan. They are in no queue, so
+        their links are free.
+    */
+    for (i = 0; i < edf->size; i++)
+    {
+        process = edf->heap[i];
+        if (process->remaining_cpu_time > 0)
+            continue;
+        process->next = finished ? finished->id : PCB_NIL;
+        finished = process;
+    }
+    while ((process = finished))
+    {
+        finished = nextBlock(process);
+        removeDeadline(edf, process);
+        terminateBlock(process);
+        recordCompletion(process, *timer);
+        freeBlock(process);
+    }
+    delegateQueue(zero, t0, one, PCB_PRIORITY_1, *timer);
+    delegateQueue(one, t1, two, PCB_PRIORITY_2, *timer);
+    delegateQueue(two, 0, NULL, PCB_PRIORITY_2, *timer);
+
+    checkAndHandleStarvation(zero, one, two, *timer, W);
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - With `-a`, holds the quanta in `scheduler` to the `-b` bounds. Each one
+    outside them is clamped with an alert naming `source`, where it came
+    from.
+
+RETURN:
+    + Nothing.
+*/
+void boundQuanta(const char *source)
+{
+    unsigned int bounded;
+    int level;
+
+    if (!options.adaptive)
+        return;
+
+    for (level = PCB_PRIORITY_0; level <= PCB_PRIORITY_2; level++)
+    {
+        bounded = boundQuantum(*scheduler.quanta[level]);
+        if (bounded == *scheduler.quanta[level])
+            continue;
+        fprintf(stderr, "ALERT: %s t%d %u is outside -b, using %u\n", source,
+                level, *scheduler.quanta[level], bounded);
+        *scheduler.quanta[level] = bounded;
+    }
+}
+
+/*
+DESCRIPTION:
+    - Reloads `t0`, `t1`, `t2` and `W` from the settings file once SIGHUP has
+    come, through the pointers in `scheduler`. This is only done at the start
+    of a whole tick. A tick cut short by an arrival is seen out with the old
+    values first. With `-a` the new quanta are held to the `-b` bounds, as
+    restored ones are.
+
+RETURN:
+    + Nothing.
+*/
+void checkAndReload(uint64_t timer)
+{
+    int64_t start = nextTickNanos() -
+                    (int64_t)options.tick_ms * EVENT_NANOS_PER_MILLI;
+
+    if (takeSignal(SIGHUP))
+        reload_pending = TRUE;
+    if (!reload_pending || cut_at > start)
+        return;
+    reload_pending = FALSE;
+
+    /*
+    NOTE:
+        - No job is moved by the reload itself. A job part of the way through
+        its quantum keeps the time it has had, and is measured against the
+        new quantum of its level at its next check. If it has had that much
+        already it is demoted at the end of the tick, otherwise it runs on
+        until it has. Waiting jobs are likewise measured against the new `W`
+        at the next starvation check.
+    */
+    if (!reloadSettings(options.settings_path,
+                        scheduler.quanta[PCB_PRIORITY_0],
+                        scheduler.quanta[PCB_PRIORITY_1],
+                        scheduler.quanta[PCB_PRIORITY_2], scheduler.W))
+    {
+        metrics.rejected_reloads++;
+        return;
+    }
+
+    boundQuanta("Reloaded");
+    metrics.reloads++;
+    fprintf(stderr, "ALERT: Settings reloaded at %" PRIu64 ": t0 %u, t1 %u, "
+                    "t2 %u, W %u\n",
+            timer, *scheduler.quanta[PCB_PRIORITY_0],
+            *scheduler.quanta[PCB_PRIORITY_1],
+            *scheduler.quanta[PCB_PRIORITY_2], *scheduler.W);
+}
+
+/*
+DESCRIPTION:
+    - Samples the depth of the JDQ, the EDF heap and each level into the
+    queue depth series, at most once a second. The JDQ includes the jobs the
+    reader has read but not handed over yet.
+
+RETURN:
+    + Nothing.
+*/
+void sampleQueues()
+{
+    uint32_t depths[WINDOW_QUEUES];
+
+    if (!isDepthSampleDue())
+        return;
+
+    depths[WINDOW_JDQ] =
+        (uint32_t)((uint64_t)pendingJobs(scheduler.jobs) + readerBacklog());
+    depths[WINDOW_EDF] = (uint32_t)scheduler.edf->size;
+    depths[WINDOW_ZERO] = (uint32_t)level_depths[PCB_PRIORITY_0];
+    depths[WINDOW_ONE] = (uint32_t)level_depths[PCB_PRIORITY_1];
+    depths[WINDOW_TWO] = (uint32_t)level_depths[PCB_PRIORITY_2];
+    sampleDepths(depths);
+}
+
+/*
+DESCRIPTION:
+    - Writes a snapshot of the scheduler into `buffer` for the stats endpoint,
+    one `key value...` line per item. It is only ever called while the dis-
+    patcher waits in the event loop, so the queues are never caught half way
+    through a change. As in the depth samples, the JDQ includes the jobs the
+    reader has read but not handed over yet. The rolling windows and the
+    latest queue depth samples follow.
+
+RETURN:
+    + The length of the snapshot.
+*/
+size_t writeStatsSnapshot(char *buffer, size_t size)
+{
+    Block *current = *scheduler.current_process;
+    uint64_t timer = *scheduler.timer;
+    uint64_t promoted, demoted, finished = metrics.finished_jobs;
+    double last_us, mean_us, max_us;
+    int length;
+
+    recentLevelMoves(timer, &promoted, &demoted);
+    sampleTickJitter(&last_us, &mean_us, &max_us);
+
+    length = snprintf(
+        buffer, size,
+        "timer %" PRIu64 "\n"
+        "tick_ms %u\n"
+        "quanta %u %u %u\n"
+        "starvation %u\n"
+        "depth jdq %" PRIu64 " edf %d zero %" PRIu64 " one %" PRIu64
+        " two %" PRIu64 "\n"
+        "running %d pid %d level %d remaining %d cycle %d\n"
+        "finished %" PRIu64 " of %" PRIu64 "\n"
+        "turnaround %" PRIu64 " waiting %" PRIu64 " response %" PRIu64 "\n"
+        "average_turnaround %.3f\n"
+        "lost %" PRIu64 "\n"
+        "deadline_jobs %" PRIu64 " misses %" PRIu64 "\n"
+        "promotions %" PRIu64 " recent %" PRIu64 "\n"
+        "demotions %" PRIu64 " recent %" PRIu64 "\n"
+        "recent_ticks %d\n"
+        "jitter_us last %.1f avg %.1f max %.1f\n",
+        timer, options.tick_ms, *scheduler.quanta[PCB_PRIORITY_0],
+        *scheduler.quanta[PCB_PRIORITY_1], *scheduler.quanta[PCB_PRIORITY_2],
+        *scheduler.W,
+        (uint64_t)pendingJobs(scheduler.jobs) + readerBacklog(),
+        scheduler.edf->size,
+        level_depths[PCB_PRIORITY_0], level_depths[PCB_PRIORITY_1],
+        level_depths[PCB_PRIORITY_2], current ? (int)current->id : -1,
+        current ? (int)blockInfo(current)->pid : 0,
+        current ? current->priority : -1,
+        current ? current->remaining_cpu_time : 0,
+        current ? current->cycle_time : 0, finished, metrics.completed_jobs,
+        metrics.total_turnaround, metrics.total_waiting,
+        metrics.total_response,
+        finished ? (double)metrics.total_turnaround / (double)finished : 0.0,
+        metrics.lost_jobs, metrics.deadline_jobs, metrics.deadline_misses,
+        metrics.promotions, promoted, metrics.demotions, demoted,
+        STATS_RECENT_TICKS, last_us, mean_us, max_us);
+
+    if (length < 0)
+        return 0;
+    if ((size_t)length >= size)
+        return size - 1;
+
+    return (size_t)length + writeWindowStats(buffer + length, size - length);
+}
+
+/*
+DESCRIPTION:
+    - Adds block `p` to the checkpoint being put together. The time it has
+    waited since it arrived is kept rather than the instant, which means
+    nothing to another run.
+
+RETURN:
+    + Nothing.
+*/
+void saveBlock(Block *p)
+{
+    BlockInfo *info = blockInfo(p);
+    BlockImage image;
+
+    memset(&image, 0, sizeof(image));
+    image.arrival_time = p->arrival_time;
+    image.deadline = p->deadline;
+    image.remaining_cpu_time = p->remaining_cpu_time;
+    image.last_queued = p->last_queued;
+    image.cycle_time = p->cycle_time;
+    image.service_time = info->service_time;
+    image.first_run = info->first_run;
+    image.priority = p->priority;
+    image.carry_ns = info->carry_ns;
+    image.waited_ns = monotonicNanos() - info->arrived_ns;
+    strncpy(image.workload, blockWorkload(p), JOBS_WORKLOAD_MAX - 1);
+    putCheckpoint(&image, sizeof(image));
+}
+
+/*
+DESCRIPTION:
+    - Adds the job at row `i` of table `t` to the checkpoint being put toget-
+    her.
+
+RETURN:
+    + Nothing.
+*/
+void saveRow(JobTable *t, int i)
+{
+    RowImage image;
+
+    memset(&image, 0, sizeof(image));
+    image.arrival = t->arrival[i];
+    image.offset_ns = t->offset_ns[i];
+    image.service = t->service[i];
+    image.deadline = t->deadline[i];
+    image.priority = t->priority[i];
+    strncpy(image.workload, t->workload[i], JOBS_WORKLOAD_MAX - 1);
+    image.held = t->held[i];
+    putCheckpoint(&image, sizeof(image));
+}
+
+/*
+DESCRIPTION:
+    - Takes a checkpoint of the scheduler through the pointers in `scheduler`
+    once `options.checkpoint_every` ticks have gone by since the last one.
+    Like a reload, this is only done at the start of a whole tick, so that
+    every job is between two ticks. The queues are copied out here and writ-
+    ten to disk on a thread of their own. While the last checkpoint is still
+    being written this one is put off to the next tick.
+
+RETURN:
+    + Nothing.
+*/
+void checkAndCheckpoint(uint64_t timer)
+{
+    Block **levels[] = {scheduler.zero, scheduler.one, scheduler.two};
+    JobTable *jobs = scheduler.jobs;
+    DeadlineHeap *edf = scheduler.edf;
+    SchedulerImage image;
+    Block *p;
+    int64_t start = nextTickNanos() -
+                    (int64_t)options.tick_ms * EVENT_NANOS_PER_MILLI;
+    int i, level;
+
+    if (timer < checkpointed_at + options.checkpoint_every ||
+        cut_at > start || !beginCheckpoint())
+    {
+        return;
+    }
+    checkpointed_at = timer;
+
+    memset(&image, 0, sizeof(image));
+    image.timer = timer;
+    image.taken = takenJobs();
+    image.tick_ms = options.tick_ms;
+    for (level = PCB_PRIORITY_0; level <= PCB_PRIORITY_2; level++)
+    {
+        image.quanta[level] = *scheduler.quanta[level];
+        image.queued[level] = (uint32_t)countTotalJobs(*levels[level]);
+    }
+    image.W = *scheduler.W;
+    image.reorder_depth = options.reorder_depth;
+    image.deadline_jobs = (uint32_t)edf->size;
+    image.rows = (uint32_t)pendingJobs(jobs);
+    image.image_size = sizeof(SchedulerImage);
+    image.metrics_size = sizeof(Metrics);
+    image.metrics = metrics;
+    putCheckpoint(&image, sizeof(image));
+
+    for (i = 0; i < edf->size; i++)
+        saveBlock(edf->heap[i]);
+    for (level = PCB_PRIORITY_0; level <= PCB_PRIORITY_2; level++)
+    {
+        for (p = *levels[level]; p; p = nextBlock(p))
+            saveBlock(p);
+    }
+    for (i = jobs->next; i < jobs->count; i++)
+        saveRow(jobs, i);
+
+    commitCheckpoint();
+}
+
+/*
+DESCRIPTION:
+    - Takes the next block out of the loaded checkpoint. Its process is not
+    running, so it is launched again the next time it is dispatched.
+
+RETURN:
+    + Block* of the job.
+    + NULL if the checkpoint has no more blocks or no block could be made.
+*/
+Block *restoreBlock()
+{
+    BlockImage image;
+    BlockInfo *info;
+    Block *p;
+
+    if (!getCheckpoint(&image, sizeof(image)) ||
+        !(p = createNullBlock()))
+    {
+        return NULL;
+    }
+    image.workload[JOBS_WORKLOAD_MAX - 1] = '\0';
+    if (!setWorkload(p, image.workload))
+    {
+        freeBlock(p);
+        return NULL;
+    }
+
+    info = blockInfo(p);
+    p->arrival_time = image.arrival_time;
+    p->deadline = image.deadline;
+    p->remaining_cpu_time = image.remaining_cpu_time;
+    p->last_queued = image.last_queued;
+    p->cycle_time = image.cycle_time;
+    p->priority = (int8_t)image.priority;
+    p->status = PCB_INITIALIZED;
+    info->service_time = image.service_time;
+    info->first_run = image.first_run;
+    info->carry_ns = image.carry_ns;
+    info->arrived_ns = monotonicNanos() - image.waited_ns;
+
+    return p;
+}
+
+/*
+DESCRIPTION:
+    - Takes the next job still to arrive out of the loaded checkpoint and puts
+    it back into table `t`.
+
+RETURN:
+    + TRUE if the job is back in the table.
+    + FALSE if the checkpoint has no more jobs or the table could not grow.
+*/
+char restoreRow(JobTable *t)
+{
+    RowImage image;
+    JobRow row;
+
+    if (!getCheckpoint(&image, sizeof(image)))
+        return FALSE;
+    image.workload[JOBS_WORKLOAD_MAX - 1] = '\0';
+
+    memset(&row, 0, sizeof(row));
+    row.arrival = image.arrival;
+    row.offset_ns = image.offset_ns;
+    row.service = image.service;
+    row.deadline = image.deadline;
+    row.priority = image.priority;
+    row.held = image.held;
+
+    return (row.workload = findWorkload(image.workload)) &&
+           insertJob(t, &row);
+}
+
+/*
+DESCRIPTION:
+    - Puts the scheduler back the way it was when the checkpoint at `path`
+    was taken, through the pointers in `scheduler`, so that the run carries
+    on from the tick it was taken at. The jobs file is read again from the
+    start, and the jobs that had already been taken from it are skipped.
+
+RETURN:
+    + TRUE if the run can carry on.
+    + FALSE if not, after printing why.
+*/
+char restoreScheduler(const char *path)
+{
+    Block **levels[] = {scheduler.zero, scheduler.one, scheduler.two};
+    Block *heads[PCB_PRIORITY_2 + 1] = {NULL};
+    Block *tails[PCB_PRIORITY_2 + 1] = {NULL};
+    SchedulerImage image;
+    Block *p;
+    uint32_t i;
+    int level;
+    char restored = TRUE;
+
+    if (!loadCheckpoint(path))
+        return FALSE;
+    if (!getCheckpoint(&image, sizeof(image)))
+    {
+        fprintf(stderr, "ERROR: Checkpoint \"%s\" is cut short\n", path);
+        return FALSE;
+    }
+    if (image.image_size != sizeof(SchedulerImage) ||
+        image.metrics_size != sizeof(Metrics))
+    {
+        fprintf(stderr, "ERROR: Checkpoint \"%s\" was taken by another build "
+                        "of the dispatcher\n",
+                path);
+        return FALSE;
+    }
+
+    /*
+    NOTE:
+        - The quanta and `W` have to be positive, as when they are typed in
+        or reloaded. With `-a` the quanta are also held to the `-b` bounds of
+        this run, which need not be those the checkpoint was taken with.
+    */
+    for (level = PCB_PRIORITY_0; level <= PCB_PRIORITY_2; level++)
+    {
+        if (!image.quanta[level])
+            break;
+    }
+    if (level <= PCB_PRIORITY_2 || !image.W)
+    {
+        fprintf(stderr, "ERROR: Checkpoint \"%s\" holds a quantum or W that "
+                        "is not positive\n",
+                path);
+        return FALSE;
+    }
+
+    /*
+    NOTE:
+        - The jobs are only put in the same order again through a reorder
+        heap of the same depth. A different tick length only changes how
+        long the ticks that are left take.
+    */
+    if (image.reorder_depth != options.reorder_depth)
+    {
+        fprintf(stderr, "ERROR: Checkpoint \"%s\" was taken with -D %d\n",
+                path, image.reorder_depth);
+        return FALSE;
+    }
+    if (image.tick_ms != options.tick_ms)
+    {
+        fprintf(stderr, "ALERT: Checkpoint \"%s\" was taken with -T %u\n",
+                path, image.tick_ms);
+    }
+    if (skipJobs(image.taken) != image.taken)
+    {
+        fprintf(stderr, "ERROR: The jobs file is shorter than when checkpoint "
+                        "\"%s\" was taken\n",
+                path);
+        return FALSE;
+    }
+
+    metrics = image.metrics;
+    *scheduler.timer = image.timer;
+    for (level = PCB_PRIORITY_0; level <= PCB_PRIORITY_2; level++)
+        *scheduler.quanta[level] = image.quanta[level];
+    *scheduler.W = image.W;
+    boundQuanta("Restored");
+    checkpointed_at = image.timer;
+
+    for (i = 0; restored && i < image.deadline_jobs; i++)
+    {
+        restored = (p = restoreBlock()) != NULL &&
+                   pushDeadline(scheduler.edf, p) != NULL;
+    }
+
+    /*
+    NOTE:
+        - Each level is chained up from its head and joined to its queue in
+        one go, as the jobs coming from the JDQ are.
+    */
+    for (level = PCB_PRIORITY_0; level <= PCB_PRIORITY_2; level++)
+    {
+        for (i = 0; restored && i < image.queued[level]; i++)
+        {
+            if (!(restored = (p = restoreBlock()) != NULL))
+                break;
+            if (tails[level])
+                tails[level]->next = p->id;
+            else
+                heads[level] = p;
+            tails[level] = p;
+            level_depths[level]++;
+        }
+        *levels[level] = appendQueue(*levels[level], heads[level]);
+    }
+    for (i = 0; restored && i < image.rows; i++)
+        restored = restoreRow(scheduler.jobs);
+
+    if (!restored || checkpointLeft())
+    {
+        fprintf(stderr, "ERROR: Could not restore checkpoint \"%s\"\n", path);
+        closeCheckpoint();
+        return FALSE;
+    }
+    closeCheckpoint();
+
+    fprintf(stderr, "ALERT: Resumed from \"%s\" at %" PRIu64 " with %" PRIu64
+                    " jobs finished\n",
+            path, image.timer, metrics.finished_jobs);
+
+    return TRUE;
+}
 #endif
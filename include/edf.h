@@ -0,0 +1,44 @@
+#ifndef EDF
+#define EDF
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+/*
+SECTION 1B: OTHER INCLUDES
+*/
+#include <pcb.h>
+
+/*
+SECTION 2: EARLIEST-DEADLINE-FIRST MACROS
+*/
+#define EDF_INITIAL_CAPACITY (16)
+#define EDF_SLACK_INITIAL_CAPACITY (64)
+
+/*
+SECTION 3: DEADLINE HEAP STRUCTURE
+*/
+typedef struct
+{
+    Block **heap;
+    int size;
+    int capacity;
+} DeadlineHeap;
+
+/*
+SECTION 4: FUNCTION PROTOTYPES
+*/
+DeadlineHeap *createDeadlineHeap(void);
+Block *pushDeadline(DeadlineHeap *, Block *);
+Block *popDeadline(DeadlineHeap *);
+Block *removeDeadline(DeadlineHeap *, Block *);
+Block *peekDeadline(DeadlineHeap *);
+char isFeasibleWith(DeadlineHeap *, Block *, uint64_t);
+void recordSlack(int);
+void printSlackDistribution(void);
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef EVENT
+#define EVENT
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <math.h>
+#include <inttypes.h>
+
+/*
+SECTION 1B: SYSTEM CALL HEADER FILES
+*/
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/types.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+/*
+SECTION 1C: OTHER INCLUDES
+*/
+#include <pcb.h>
+
+/*
+SECTION 2: EVENT LOOP MACROS
+*/
+#define EVENT_PENDING_NONE (0)
+#define EVENT_PENDING_STOP (1)
+#define EVENT_PENDING_CONT (2)
+#define EVENT_PENDING_EXIT (3)
+
+#define EVENT_DEFAULT_TIMEOUT_MS (2000)
+#define EVENT_MAX_EVENTS (16)
+#define EVENT_INITIAL_CHILDREN (64)
+#define EVENT_HASH_MULTIPLIER (2654435761u)
+#define EVENT_NANOS_PER_MILLI (1000000LL)
+#define EVENT_NANOS_PER_SECOND (1000000000LL)
+#define EVENT_NO_QUARANTINE (0)
+#define EVENT_MAX_WATCHED (32)
+
+/*
+SECTION 3: SUPERVISED CHILD STRUCTURE
+*/
+typedef struct
+{
+    pid_t pid;
+    Block *block;
+    int pending;
+    int escalation;
+    int64_t expires;
+    char stopped;
+} Child;
+
+/*
+SECTION 4: FUNCTION PROTOTYPES
+*/
+char initializeEventLoop(unsigned int, unsigned int);
+char catchSignal(int);
+char takeSignal(int);
+char watchDescriptor(int, void (*)(int));
+void unwatchDescriptor(int);
+void configureWatchdog(int);
+void watchChild(pid_t, Block *);
+void expectChild(pid_t, int);
+void adoptChild(pid_t, Block *);
+void releaseChild(pid_t);
+char isChildAlive(pid_t);
+char isChildStopped(pid_t);
+Block *collectLostChild(void);
+int countChildren(void);
+void signalChildren(pid_t *, int, int, int);
+void awaitTick(void);
+void armArrival(int64_t);
+char awaitSlice(void);
+void awaitPending(void);
+void awaitChildren(void);
+int64_t monotonicNanos(void);
+uint64_t sampleTickJitter(double *, double *, double *);
+void printTickJitter(void);
+void printWatchdogStats(void);
+int64_t nextTickNanos(void);
+
+#endif
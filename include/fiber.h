@@ -0,0 +1,59 @@
+#ifndef FIBER
+#define FIBER
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <math.h>
+#include <time.h>
+#include <ucontext.h>
+
+/*
+SECTION 1B: SYSTEM CALL HEADER FILES
+*/
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*
+SECTION 2: FIBER MACROS
+*/
+#define FIBER_KERNEL_INT (0)
+#define FIBER_KERNEL_FLOAT (1)
+
+#define FIBER_STACK_SIZE (16 * 1024)
+#define FIBER_CHUNK (4096)
+
+/*
+SECTION 3: FIBER STRUCTURE
+*/
+/*
+NOTE:
+    - A job run as a coroutine inside the dispatcher. It burns CPU with the
+    configured kernel in chunks and yields back to the dispatcher at the
+    first chunk boundary past `until`, which is how it is preempted.
+*/
+typedef struct Fiber
+{
+    ucontext_t context;
+    void *stack;
+    int64_t until;
+    uint64_t iterations;
+    uint64_t cpu_ns;
+    uint64_t state;
+    double value;
+} Fiber;
+
+/*
+SECTION 4: FUNCTION PROTOTYPES
+*/
+void configureFibers(int, char);
+Fiber *createFiber(void);
+void runFiber(Fiber *, int64_t);
+void destroyFiber(Fiber *);
+void printFiberStats(void);
+
+#endif
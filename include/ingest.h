@@ -0,0 +1,80 @@
+#ifndef INGEST
+#define INGEST
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+
+/*
+SECTION 1B: SYSTEM CALL HEADER FILES
+*/
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/*
+SECTION 1C: OTHER INCLUDES
+*/
+#include <pcb.h>
+#include <jobs.h>
+#include <event.h>
+
+/*
+SECTION 2: INGEST MACROS
+*/
+#define INGEST_BACKLOG (16)
+#define INGEST_MAX_SOURCES (EVENT_MAX_WATCHED - 2)
+#define INGEST_READ_SIZE (4096)
+
+/*
+SECTION 3: INGEST STRUCTURES
+*/
+/*
+NOTE:
+    - A job on its way in. Producers link nodes onto the head of the queue
+    with one atomic exchange each. The dispatcher alone takes them off the
+    tail.
+*/
+typedef struct IngestNode
+{
+    struct IngestNode *next;
+    JobRow row;
+} IngestNode;
+
+/*
+NOTE:
+    - A FIFO or socket connection that jobs are read from, one per line. A
+    line that has not been finished yet waits in `pending`. Once a line has
+    grown too long for it, `overlong` is set and the rest of the line is
+    thrown away as it comes.
+*/
+typedef struct
+{
+    int fd;
+    char pending[JOBS_LINE_MAX];
+    int pending_length;
+    char overlong;
+} IngestSource;
+
+/*
+SECTION 4: FUNCTION PROTOTYPES
+*/
+void configureIngest(int64_t, const char *);
+char submitIngest(JobRow *);
+int drainIngest(JobTable *, uint64_t);
+char openIngestFifo(const char *);
+char openIngestSocket(const char *);
+char isIngestOpen(void);
+void closeIngest(void);
+void printIngestStats(void);
+
+#endif
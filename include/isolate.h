@@ -0,0 +1,37 @@
+#ifndef ISOLATE
+#define ISOLATE
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+/*
+SECTION 1B: SYSTEM CALL HEADER FILES
+*/
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/*
+SECTION 1C: OTHER INCLUDES
+*/
+#include <pcb.h>
+
+/*
+SECTION 2: ISOLATION MACROS
+*/
+#define ISOLATE_NO_CPU (-1)
+#define ISOLATE_RT_PRIORITY (10)
+
+/*
+SECTION 3: FUNCTION PROTOTYPES
+*/
+char configureIsolation(int, char *, char, char);
+void isolateChild(pid_t);
+
+#endif
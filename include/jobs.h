@@ -0,0 +1,110 @@
+#ifndef JOBS
+#define JOBS
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+/*
+SECTION 1B: OTHER INCLUDES
+*/
+#include <pcb.h>
+
+/*
+SECTION 2: JOB TABLE MACROS
+*/
+#define JOBS_INITIAL_CAPACITY (1024)
+#define JOBS_SPLIT_COUNT (3)
+#define JOBS_SPLIT_DEADLINE (4)
+#define JOBS_SPLIT_WORKLOAD (5)
+#define JOBS_LINE_MAX (256)
+#define JOBS_WORKLOAD_MAX (16)
+#define JOBS_ARRIVE_NOW (-1)
+#define JOBS_DEFAULT_REORDER (4096)
+#define JOBS_NO_REORDER (0)
+#define JOBS_QUARANTINE_SHOWN (10)
+
+/*
+SECTION 3: JOB TABLE STRUCTURE
+*/
+
+/*
+NOTE:
+    - One job as read from the jobs file, before it goes into the table.
+    `order` is its place in the file, which breaks ties in arrival. A job
+    submitted at run time may arrive JOBS_ARRIVE_NOW instead. `held` is how
+    many ticks after `arrival` the job was released, for one that came too
+    late for the reorder heap.
+*/
+typedef struct
+{
+    int arrival;
+    int64_t offset_ns;
+    int service;
+    int deadline;
+    int priority;
+    const char *workload;
+    uint64_t order;
+    int held;
+} JobRow;
+
+/*
+NOTE:
+    - Jobs that have not arrived yet, one array per column and sorted by
+    arrival. A job only gets a block once it arrives. Everything before
+    `next` has arrived already.
+
+    - Jobs reach the table through a min-heap of up to `reorder_depth` rows,
+    so a job can come up to that many lines late in the file and still take
+    its place. A job that comes later than that can no longer go back, and
+    is released with the last job let through instead. `arrival` is when a
+    job is released and `held` how far that is past its real arrival, which
+    is what its block gets. With no depth the whole file is read and then
+    sorted.
+*/
+typedef struct
+{
+    int *arrival;
+    int64_t *offset_ns;
+    int *service;
+    int *deadline;
+    int8_t *priority;
+    const char **workload;
+    int *held;
+
+    int count;
+    int capacity;
+    int next;
+
+    JobRow *reorder;
+    int reorder_size;
+    int reorder_depth;
+    uint64_t submitted;
+    uint64_t late;
+    int most_late;
+} JobTable;
+
+/*
+SECTION 4: FUNCTION PROTOTYPES
+*/
+const char *parseJob(const char *, JobRow *, int64_t, const char *);
+JobTable *createJobTable(int);
+char submitJob(JobTable *, JobRow *);
+char finishJobTable(JobTable *);
+char insertJob(JobTable *, JobRow *);
+void compactJobTable(JobTable *);
+void printReorderStats(JobTable *);
+void quarantineJob(int, const char *, const char *);
+void printQuarantine(void);
+int pendingJobs(JobTable *);
+int findArrivals(JobTable *, int, int64_t);
+Block *takeJob(JobTable *);
+char takeRow(JobTable *, JobRow *);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef LAUNCH
+#define LAUNCH
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+
+/*
+SECTION 1B: SYSTEM CALL HEADER FILES
+*/
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/*
+SECTION 1C: OTHER INCLUDES
+*/
+#include <pcb.h>
+
+/*
+SECTION 2: LAUNCH MACROS
+*/
+#define SPAWN_POSIX (0)
+#define SPAWN_FORK (1)
+#define SPAWN_FDEXEC (2)
+
+#define LAUNCH_BACKOFF_MIN_MS (10)
+#define LAUNCH_BACKOFF_MAX_MS (1000)
+
+/*
+SECTION 3: FUNCTION PROTOTYPES
+*/
+char configureSpawn(int, char *);
+char silenceSpawnOutput(void);
+char canSpawn(void);
+uint64_t getProcessLimit(void);
+pid_t spawnProcess(char **);
+void printSpawnLatency(void);
+
+#endif
@@ -6,15 +6,25 @@ SECTION 1A: C STANDARD LIBRARY INCLUDES
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
 
 /*
 SECTION 1B: SYSTEM CALL HEADER FILES
 */
+#include <sched.h>
 #include <signal.h>
+#include <sys/resource.h>
 #include <sys/wait.h>
 #include <sys/types.h>
 #include <unistd.h>
 
+/*
+SECTION 1C: OTHER INCLUDES
+*/
+#include <channel.h>
+
 /*
 SECTION 2: AUXILIARY MACROS
 */
@@ -35,48 +45,118 @@ SECTION 3: PROCESS MANAGEMENT MACROS
 #define PCB_RUNNING (3)
 #define PCB_SUSPENDED (4)
 #define PCB_TERMINATED (5)
-#define PCB_MAX_ARGS (3)
+#define PCB_MAX_ARGS (8)
 #define PCB_ARGS_PNAME (0)
 #define PCB_ARGS_ENDNULL (1)
+#define PCB_ARGS_WORKLOAD (1)
+#define PCB_WORKLOAD_FLAG "-w"
+#define PCB_WORKLOAD_SLEEP "sleep"
+#define PCB_WORKLOAD_SPIN "spin"
+
+#define PCB_NIL (UINT32_MAX)
+#define PCB_SLAB_SHIFT (16)
+#define PCB_SLAB_BLOCKS (1 << PCB_SLAB_SHIFT)
+#define PCB_MAX_SLABS (4096)
+#define PCB_SLAB_ALIGN (64)
 
 #define PCB_DEFAULT_PRIORITY (-1)
 #define PCB_PRIORITY_0 (0)
 #define PCB_PRIORITY_1 (1)
 #define PCB_PRIORITY_2 (2)
 
+#define PCB_NO_DEADLINE (-1)
+#define PCB_NOT_RUN (-1)
+
+#define PCB_EXEC_SIGNAL (0)
+#define PCB_EXEC_CGROUP (1)
+#define PCB_EXEC_CHANNEL (2)
+#define PCB_EXEC_FIBER (3)
+
+#define PCB_LEVEL_UNSET (-1)
+#define PCB_NICE_0 (-5)
+#define PCB_NICE_1 (10)
+
+/*
+SECTION 4: PROCESS CONTROL BLOCK STRUCTURES
+*/
+
 /*
-SECTION 4: PROCESS CONTROL BLOCK STRUCTURE
+NOTE:
+    - The block proper only holds what the scheduler reads and writes on every
+    pass over a queue. At 32 bytes two of them share a cache line. Blocks live
+    in slabs that never move, and `next` is the 32-bit ID of the next block
+    in the same queue rather than a pointer.
 */
 struct Process
 {
-    pid_t pid;
+    uint32_t next;
+    uint32_t id;
 
-    char *args[PCB_MAX_ARGS];
     int arrival_time;
-    int service_time;
+    int deadline;
     int remaining_cpu_time;
     int last_queued;
     int cycle_time;
-    
-    int priority;
-    int status;
 
-    struct Process *next;
+    int8_t priority;
+    int8_t status;
 };
 
 typedef struct Process Block;
 
+/*
+NOTE:
+    - Everything else about a job, which is only needed when its process is
+    launched, signalled, charged or reported. It is kept in a side table at
+    the same ID as its block.
+*/
+typedef struct
+{
+    pid_t pid;
+
+    char *args[PCB_MAX_ARGS];
+    int64_t arrived_ns;
+    int service_time;
+    int first_run;
+    int timeouts;
+
+    char in_cgroup;
+    uint64_t cpu_usec;
+    uint64_t cpu_ns;
+    uint64_t carry_ns;
+    int applied_level;
+
+    int slot;
+    char channel_arg[CHANNEL_ARG_MAX];
+
+    struct Fiber *fiber;
+} BlockInfo;
+
 /*
 SECTION 5: FUNCTION PROTOTYPES
 */
 Block *createNullBlock();
+void freeBlock(Block *);
+Block *blockAt(uint32_t);
+BlockInfo *blockInfo(Block *);
+Block *nextBlock(Block *);
+void setExecutor(int);
+const char *findWorkload(const char *);
+Block *setWorkload(Block *, const char *);
+const char *blockWorkload(Block *);
 Block *enqueueBlock(Block *, Block *);
 Block *dequeueBlock(Block **);
+Block *removeBlock(Block **, Block *);
+Block *unlinkBlock(Block **, Block *, Block *);
+Block *appendQueue(Block *, Block *);
 Block *startBlock(Block *);
 Block *terminateBlock(Block *);
 Block *resumeBlock(Block *);
 Block *suspendBlock(Block *);
 Block *printBlock(Block *);
+uint64_t sampleBlockCpu(Block *);
+Block *prioritizeBlock(Block *, int);
+Block *runBlock(Block *, int64_t);
 void printBlockHeader(void);
 
 #endif
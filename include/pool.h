@@ -0,0 +1,42 @@
+#ifndef POOL
+#define POOL
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+
+/*
+SECTION 1B: SYSTEM CALL HEADER FILES
+*/
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/*
+SECTION 1C: OTHER INCLUDES
+*/
+#include <pcb.h>
+
+/*
+SECTION 2: WORKER POOL MACROS
+*/
+#define POOL_REFILL_BATCH (4)
+#define POOL_LEAD_TICKS (2)
+#define POOL_RATE_WEIGHT (0.25)
+
+/*
+SECTION 3: FUNCTION PROTOTYPES
+*/
+char initializePool(int, char **);
+void noteArrival(void);
+void refillPool(uint64_t);
+pid_t takeWorker(char **);
+void recordFirstDispatch(char, int64_t);
+void drainPool(void);
+void printPoolStats(void);
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef READER
+#define READER
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+/*
+SECTION 1B: SYSTEM CALL HEADER FILES
+*/
+#include <linux/futex.h>
+#include <signal.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/*
+SECTION 1C: OTHER INCLUDES
+*/
+#include <pcb.h>
+#include <jobs.h>
+#include <event.h>
+
+/*
+SECTION 2: TRACE READER MACROS
+*/
+#define READER_RING_SIZE (4096)
+#define READER_RING_MASK (READER_RING_SIZE - 1)
+#define READER_RING_ALIGN (64)
+#define READER_END_OF_TRACE (UINT64_MAX)
+#define READER_TRACE_FAILED (UINT64_MAX - 1)
+
+/*
+SECTION 3: TRACE READER STRUCTURE
+*/
+/*
+NOTE:
+    - Jobs on their way from the reader thread to the dispatcher, in arrival
+    order. Only the reader writes `head` and only the dispatcher writes
+    `tail`. Both count rows from the start of the trace and wrap, which is
+    harmless as the ring size divides 2^32. Each is on a line of its own,
+    and doubles as the futex word the other side waits on.
+*/
+typedef struct
+{
+    uint32_t head __attribute__((aligned(READER_RING_ALIGN)));
+    uint32_t reader_waiting;
+    uint32_t tail __attribute__((aligned(READER_RING_ALIGN)));
+    uint32_t dispatcher_waiting;
+    JobRow rows[READER_RING_SIZE] __attribute__((aligned(READER_RING_ALIGN)));
+} JobRing;
+
+/*
+SECTION 4: FUNCTION PROTOTYPES
+*/
+char openReader(const char *, int, int64_t, const char *);
+int pullJobs(JobTable *, uint64_t);
+uint64_t skipJobs(uint64_t);
+uint64_t takenJobs(void);
+uint64_t readerBacklog(void);
+char readerFailed(void);
+void closeReader(void);
+void printReaderStats(void);
+
+#endif
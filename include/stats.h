@@ -0,0 +1,60 @@
+#ifndef STATS
+#define STATS
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+
+/*
+SECTION 1B: SYSTEM CALL HEADER FILES
+*/
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/*
+SECTION 1C: OTHER INCLUDES
+*/
+#include <pcb.h>
+#include <event.h>
+
+/*
+SECTION 2: STATS ENDPOINT MACROS
+*/
+#define STATS_BACKLOG (16)
+#define STATS_BUFFER_SIZE (16384)
+#define STATS_RECENT_TICKS (64)
+
+/*
+SECTION 3: RECENT LEVEL MOVES STRUCTURE
+*/
+/*
+NOTE:
+    - Promotions and demotions during one tick, in a ring with a slot per
+    tick. A slot is reset the first time it is used for a newer tick.
+*/
+typedef struct
+{
+    uint64_t tick;
+    uint64_t promoted;
+    uint64_t demoted;
+} LevelMoves;
+
+/*
+SECTION 4: FUNCTION PROTOTYPES
+*/
+char openStatsSocket(const char *, size_t (*)(char *, size_t));
+void closeStatsSocket(void);
+void noteLevelMoves(uint64_t, int, int);
+void recentLevelMoves(uint64_t, uint64_t *, uint64_t *);
+void printStatsServed(void);
+
+#endif
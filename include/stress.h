@@ -0,0 +1,39 @@
+#ifndef STRESS
+#define STRESS
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <errno.h>
+
+/*
+SECTION 1B: SYSTEM CALL HEADER FILES
+*/
+#include <signal.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/*
+SECTION 1C: OTHER INCLUDES
+*/
+#include <pcb.h>
+
+/*
+SECTION 2: STRESS MODE MACROS
+*/
+#define STRESS_FIRST_CHECKPOINT (1000)
+#define STRESS_SAMPLE (256)
+#define STRESS_LOOKUPS (100000)
+#define STRESS_STARVATION_WINDOW (8)
+
+/*
+SECTION 3: FUNCTION PROTOTYPES
+*/
+int runStress(int, char **);
+int runFiberStress(int);
+int runQueueStress(int);
+
+#endif
@@ -0,0 +1,89 @@
+#ifndef WINDOW
+#define WINDOW
+
+/*
+SECTION 1A: C STANDARD LIBRARY INCLUDES
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <stdarg.h>
+
+/*
+SECTION 1B: OTHER INCLUDES
+*/
+#include <event.h>
+
+/*
+SECTION 2: ROLLING WINDOW MACROS
+*/
+#define WINDOW_SHORT (60)
+#define WINDOW_MEDIUM (300)
+#define WINDOW_LONG (3600)
+#define WINDOW_SLOT_SECONDS (10)
+#define WINDOW_SLOTS (WINDOW_LONG / WINDOW_SLOT_SECONDS)
+
+#define WINDOW_TURNAROUND (0)
+#define WINDOW_WAITING (1)
+#define WINDOW_RESPONSE (2)
+#define WINDOW_METRICS (3)
+#define WINDOW_NO_RESPONSE (UINT64_MAX)
+#define WINDOW_SUB_BITS (2)
+#define WINDOW_SUB_BINS (1 << WINDOW_SUB_BITS)
+#define WINDOW_EXACT_BINS (2 * WINDOW_SUB_BINS)
+#define WINDOW_BINS (128)
+
+#define WINDOW_JDQ (0)
+#define WINDOW_EDF (1)
+#define WINDOW_ZERO (2)
+#define WINDOW_ONE (3)
+#define WINDOW_TWO (4)
+#define WINDOW_QUEUES (5)
+#define WINDOW_SAMPLES (WINDOW_LONG)
+#define WINDOW_SERIES_SHOWN (60)
+
+/*
+SECTION 3: ROLLING WINDOW STRUCTURES
+*/
+/*
+NOTE:
+    - Jobs finished during one period of WINDOW_SLOT_SECONDS, with a histo-
+    gram of each of their times. Bins are exact below WINDOW_EXACT_BINS and
+    then split every power of two into WINDOW_SUB_BINS, so a percentile is
+    never more than a quarter out. A slot is reset the first time it is used
+    for a newer period.
+*/
+typedef struct
+{
+    uint64_t period;
+    uint32_t finished;
+    uint32_t responded;
+    uint32_t histogram[WINDOW_METRICS][WINDOW_BINS];
+} WindowSlot;
+
+/*
+NOTE:
+    - The depth of each queue as sampled during one second, one sample per
+    second in a ring. Only the dispatcher writes samples. `sequence` is odd
+    while a sample is being written, so a reader on any thread can tell it
+    caught one half way and read it again, without taking a lock.
+*/
+typedef struct
+{
+    uint32_t sequence;
+    uint32_t depth[WINDOW_QUEUES];
+    uint64_t second;
+} DepthSample;
+
+/*
+SECTION 4: FUNCTION PROTOTYPES
+*/
+void noteFinished(uint64_t, uint64_t, uint64_t);
+char isDepthSampleDue(void);
+void sampleDepths(const uint32_t *);
+int readDepthSeries(DepthSample *, int);
+size_t writeWindowStats(char *, size_t);
+
+#endif
@@ -0,0 +1,174 @@
+#include <adapt.h>
+
+/*
+NOTE:
+    - One sliding window per level. Every time a job leaves a level, either by
+    finishing there or by being demoted out of it, one sample is recorded.
+*/
+static LevelWindow windows[ADAPT_LEVELS];
+static int window_size = ADAPT_DEFAULT_WINDOW;
+static double target_fraction = ADAPT_DEFAULT_TARGET;
+static unsigned int quantum_min = ADAPT_DEFAULT_MIN;
+static unsigned int quantum_max = ADAPT_DEFAULT_MAX;
+
+/*
+DESCRIPTION:
+    - Compares two integers for `qsort()`.
+
+RETURNS:
+    + Negative, zero or positive as per `qsort()` conventions.
+*/
+static int compareInts(const void *a, const void *b)
+{
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+DESCRIPTION:
+    - Sets the window size, the target fraction of jobs that should finish in
+    the level they are in, and the bounds every quantum is clamped to. Out of
+    range values are clamped to something usable.
+
+RETURNS:
+    + Nothing.
+*/
+void configureAdaptation(int window, double target, unsigned int min,
+                         unsigned int max)
+{
+    if (window < ADAPT_MIN_SAMPLES)
+        window = ADAPT_MIN_SAMPLES;
+    if (window > ADAPT_MAX_WINDOW)
+        window = ADAPT_MAX_WINDOW;
+    if (target <= 0.0 || target > 1.0)
+        target = ADAPT_DEFAULT_TARGET;
+    if (!min)
+        min = 1;
+    if (max < min)
+        max = min;
+
+    window_size = window;
+    target_fraction = target;
+    quantum_min = min;
+    quantum_max = max;
+}
+
+/*
+DESCRIPTION:
+    - Clamps `quantum` to the bounds set by `configureAdaptation()`.
+
+RETURNS:
+    + The clamped quantum.
+*/
+unsigned int boundQuantum(unsigned int quantum)
+{
+    if (quantum < quantum_min)
+        return quantum_min;
+    if (quantum > quantum_max)
+        return quantum_max;
+
+    return quantum;
+}
+
+/*
+DESCRIPTION:
+    - Records that a job left `level`. The `consumed` value is the CPU time it
+    used during its stay, which is its whole demand at this level if it fini-
+    shed and a lower bound on it if it was demoted.
+
+RETURNS:
+    + Nothing.
+*/
+void observeExit(int level, char finished, int consumed)
+{
+    LevelWindow *w;
+
+    if (level < 0 || level >= ADAPT_LEVELS)
+        return;
+
+    w = &windows[level];
+    w->consumed[w->head] = consumed;
+    w->finished[w->head] = finished;
+    w->head = (w->head + 1) % window_size;
+    if (w->count < window_size)
+        w->count++;
+    w->dirty = TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Re-tunes the quantum of `level` from its window.
+
+    - If fewer jobs than the target finish at the level, the quantum grows in
+    proportion to the shortfall. Demoted jobs only tell us their demand was
+    larger than the quantum, so we cannot do better than stepping up.
+
+    - If enough jobs finish, the quantum shrinks to the smallest value that
+    still lets the target fraction of the window finish, taken from the serv-
+    ice times of the jobs that did finish. Short quanta keep response low.
+
+    - The window of a level is cleared after each change, since its samples
+    were taken under the old quantum.
+
+RETURNS:
+    + TRUE if the quantum was changed, after logging the change.
+    + FALSE if it was left alone.
+*/
+char adaptQuantum(int level, unsigned int *quantum, uint64_t timer)
+{
+    LevelWindow *w;
+    int sorted[ADAPT_MAX_WINDOW];
+    int finished = 0, needed, i;
+    unsigned int proposed = *quantum;
+    double fraction;
+
+    if (level < 0 || level >= ADAPT_LEVELS)
+        return FALSE;
+
+    w = &windows[level];
+    if (!w->dirty || w->count < ADAPT_MIN_SAMPLES)
+        return FALSE;
+    w->dirty = FALSE;
+
+    for (i = 0; i < w->count; i++)
+    {
+        if (w->finished[i])
+            sorted[finished++] = w->consumed[i];
+    }
+    fraction = (double)finished / (double)w->count;
+
+    if (fraction < target_fraction)
+    {
+        unsigned int step = (unsigned int)((target_fraction - fraction) *
+                                           (*quantum) + 0.5);
+        proposed = *quantum + (step ? step : 1);
+    }
+    else
+    {
+        qsort(sorted, finished, sizeof(int), compareInts);
+        needed = (int)(target_fraction * w->count + 0.999);
+        if (needed < 1)
+            needed = 1;
+        if (needed > finished)
+            needed = finished;
+        if (sorted[needed - 1] > 0)
+            proposed = (unsigned int)sorted[needed - 1];
+    }
+
+    proposed = boundQuantum(proposed);
+    if (proposed == *quantum)
+        return FALSE;
+
+    printf("ADAPT: t%d %u -> %u at time %" PRIu64
+           " (%d of %d finished in level, target %.2f)\n",
+           level, *quantum, proposed, timer, finished, w->count,
+           target_fraction);
+
+    *quantum = proposed;
+    w->head = 0;
+    w->count = 0;
+
+    return TRUE;
+}
@@ -0,0 +1,302 @@
+#include <cgroup.h>
+
+/*
+NOTE:
+    - Every job gets its own leaf cgroup under a parent created for this run
+    inside the dispatcher's own cgroup v2 directory. Leaves are named after
+    the pid of the job's main process. `base` stops CGROUP_LEAF_ROOM short
+    of PATH_MAX, which leaves room for a leaf and the file inside it.
+*/
+static char base[PATH_MAX - CGROUP_LEAF_ROOM] = "";
+static char enabled = FALSE;
+
+/*
+NOTE:
+    - Leaves of terminated jobs. They are removed once the kernel lets us,
+    which is when every process in them has exited.
+*/
+static pid_t *retired = NULL;
+static int retired_count = 0;
+static int retired_capacity = 0;
+
+/*
+DESCRIPTION:
+    - Builds the path of `file` inside the leaf of job `pid` into `path`. An
+    empty `file` gives the leaf directory itself.
+
+RETURNS:
+    + TRUE if the path fits in PATH_MAX.
+    + FALSE if it would have been cut short.
+*/
+static char leafPath(char *path, pid_t pid, const char *file)
+{
+    int length = snprintf(path, PATH_MAX, "%s/job.%d%s%s", base, (int)pid,
+                          *file ? "/" : "", file);
+
+    return length >= 0 && length < PATH_MAX;
+}
+
+/*
+DESCRIPTION:
+    - Writes `value` to the control file at `path`.
+
+RETURNS:
+    + TRUE if the whole value was written.
+    + FALSE otherwise.
+*/
+static char writeControl(const char *path, const char *value)
+{
+    int fd, length = (int)strlen(value);
+    char written;
+
+    if ((fd = open(path, O_WRONLY | O_CLOEXEC)) < 0)
+        return FALSE;
+    written = write(fd, value, length) == length;
+    close(fd);
+
+    return written;
+}
+
+/*
+DESCRIPTION:
+    - Finds where cgroup v2 is mounted and which cgroup the dispatcher is in,
+    and creates a parent cgroup for this run beneath it.
+
+RETURNS:
+    + TRUE if the parent cgroup was created, so the hierarchy is writable.
+    + FALSE if there is no cgroup v2 hierarchy or we may not write to it.
+*/
+char initializeCgroups()
+{
+    char mount[PATH_MAX] = "", self[CGROUP_LINE_MAX] = "";
+    char line[CGROUP_LINE_MAX];
+    struct mntent *entry;
+    FILE *file;
+    int length;
+
+    if (!(file = setmntent("/proc/self/mounts", "r")))
+        return FALSE;
+    while ((entry = getmntent(file)))
+    {
+        if (!strcmp(entry->mnt_type, "cgroup2"))
+        {
+            snprintf(mount, sizeof(mount), "%s", entry->mnt_dir);
+            break;
+        }
+    }
+    endmntent(file);
+
+    if (!*mount || !(file = fopen("/proc/self/cgroup", "r")))
+        return FALSE;
+    while (fgets(line, sizeof(line), file))
+    {
+        if (!strncmp(line, "0::", 3))
+        {
+            line[strcspn(line, "\n")] = '\0';
+            snprintf(self, sizeof(self), "%s", line + 3);
+            break;
+        }
+    }
+    fclose(file);
+
+    /*
+    NOTE:
+        - The root cgroup is reported as "/", which would leave a double slash
+        in every path.
+    */
+    if (!strcmp(self, "/"))
+        *self = '\0';
+
+    length = snprintf(base, sizeof(base), "%s%s/mlq.%d", mount, self,
+                      (int)getpid());
+    if (length < 0 || length >= (int)sizeof(base) || mkdir(base, 0755) < 0)
+        return FALSE;
+
+    enabled = TRUE;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Creates the leaf of job `pid` and moves the process into it. Anything
+    the job forks from now on stays in the same leaf.
+
+RETURNS:
+    + TRUE if the process is in its own leaf.
+    + FALSE if not, in which case the job has to be driven with signals.
+*/
+char attachCgroup(pid_t pid)
+{
+    char path[PATH_MAX], value[CGROUP_VALUE_MAX];
+
+    if (!enabled)
+        return FALSE;
+
+    if (!leafPath(path, pid, "") || mkdir(path, 0755) < 0)
+        return FALSE;
+
+    leafPath(path, pid, "cgroup.procs");
+    snprintf(value, sizeof(value), "%d", (int)pid);
+    if (!writeControl(path, value))
+    {
+        leafPath(path, pid, "");
+        rmdir(path);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Freezes or thaws every process in the leaf of job `pid` at once.
+
+RETURNS:
+    + TRUE if the freezer accepted the request.
+    + FALSE otherwise.
+*/
+char freezeCgroup(pid_t pid, char frozen)
+{
+    char path[PATH_MAX];
+
+    return leafPath(path, pid, "cgroup.freeze") &&
+           writeControl(path, frozen ? "1" : "0");
+}
+
+/*
+DESCRIPTION:
+    - Reads the CPU time consumed so far by every process in the leaf of job
+    `pid`, from `usage_usec` in its `cpu.stat`.
+
+RETURNS:
+    + The CPU time in microseconds.
+    + 0 if it could not be read.
+*/
+uint64_t readCgroupUsage(pid_t pid)
+{
+    char path[PATH_MAX], line[CGROUP_LINE_MAX];
+    uint64_t usage = 0;
+    FILE *file;
+
+    if (!leafPath(path, pid, "cpu.stat") || !(file = fopen(path, "r")))
+        return 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        if (sscanf(line, "usage_usec %" SCNu64, &usage) == 1)
+            break;
+    }
+    fclose(file);
+
+    return usage;
+}
+
+/*
+DESCRIPTION:
+    - Kills every process left in the leaf of job `pid` other than the job's
+    main process, which has been asked to exit and is left to do so.
+
+RETURNS:
+    + Nothing.
+*/
+static void killHelpers(pid_t pid)
+{
+    char path[PATH_MAX];
+    FILE *file;
+    int helper;
+
+    if (!leafPath(path, pid, "cgroup.procs") || !(file = fopen(path, "r")))
+        return;
+    while (fscanf(file, "%d", &helper) == 1)
+    {
+        if (helper != (int)pid)
+            kill((pid_t)helper, SIGKILL);
+    }
+    fclose(file);
+}
+
+/*
+DESCRIPTION:
+    - Kills whatever the finished job `pid` left running in its leaf, marks
+    the leaf for removal, and tries removing every marked leaf. The job has
+    only just been asked to exit, so its own leaf usually goes on a later
+    sweep.
+
+RETURNS:
+    + Nothing.
+*/
+void retireCgroup(pid_t pid)
+{
+    killHelpers(pid);
+
+    if (retired_count == retired_capacity)
+    {
+        int capacity = retired_capacity ? 2 * retired_capacity
+                                        : CGROUP_INITIAL_RETIRED;
+        pid_t *grown = (pid_t *)realloc(retired, capacity * sizeof(pid_t));
+        if (!grown)
+        {
+            fprintf(stderr, "ERROR: Could not retire cgroup of %d\n",
+                    (int)pid);
+            return;
+        }
+        retired = grown;
+        retired_capacity = capacity;
+    }
+
+    retired[retired_count++] = pid;
+    sweepCgroups();
+}
+
+/*
+DESCRIPTION:
+    - Removes the retired leaves that have emptied out.
+
+RETURNS:
+    + Nothing.
+*/
+void sweepCgroups()
+{
+    char path[PATH_MAX];
+    int i;
+
+    for (i = retired_count - 1; i >= 0; i--)
+    {
+        if (!leafPath(path, retired[i], "") || !rmdir(path))
+            retired[i] = retired[--retired_count];
+    }
+}
+
+/*
+DESCRIPTION:
+    - Removes every remaining leaf and the parent cgroup of this run. Helpers
+    a job left behind are killed through `cgroup.kill` so that its leaf can
+    go.
+
+RETURNS:
+    + Nothing.
+*/
+void cleanupCgroups()
+{
+    char path[PATH_MAX];
+    int i, attempt;
+
+    if (!enabled)
+        return;
+
+    for (attempt = 0; attempt < CGROUP_CLEANUP_ATTEMPTS; attempt++)
+    {
+        sweepCgroups();
+        if (!retired_count)
+            break;
+        for (i = 0; i < retired_count; i++)
+        {
+            if (leafPath(path, retired[i], "cgroup.kill"))
+                writeControl(path, "1");
+        }
+        usleep(CGROUP_CLEANUP_WAIT_US);
+    }
+
+    if (rmdir(base) < 0)
+        fprintf(stderr, "WARNING: Could not remove cgroup \"%s\"\n", base);
+}
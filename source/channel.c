@@ -0,0 +1,223 @@
+#include <channel.h>
+#include <event.h>
+
+/*
+NOTE:
+    - The shared region lives in a memfd that every child inherits, so a
+    worker only needs the descriptor number and its slot index to map it.
+*/
+static WorkerSlot *slots = NULL;
+static int channel_fd = -1;
+
+/*
+NOTE:
+    - Slots of exited jobs are only handed out again once the event loop has
+    reaped their worker, so that a late worker can never act on the next
+    job's control word. Going by the reaped exit rather than by whether the
+    pid answers means a reused pid cannot hold a slot back.
+*/
+static int free_slots[CHANNEL_MAX_SLOTS];
+static int free_count = 0;
+static int retiring[CHANNEL_MAX_SLOTS];
+static int retiring_count = 0;
+
+static uint64_t park_count = 0;
+static int64_t park_total = 0;
+static int64_t park_max = 0;
+
+/*
+DESCRIPTION:
+    - Wakes the worker waiting on the control word of slot `slot`.
+
+RETURNS:
+    + Nothing.
+*/
+static void wakeSlot(int slot)
+{
+    syscall(SYS_futex, &slots[slot].control, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+/*
+DESCRIPTION:
+    - Records how long the worker in slot `slot` took to park after it was
+    asked to, if it did park since the last request.
+
+RETURNS:
+    + Nothing.
+*/
+static void collectParkLatency(int slot)
+{
+    WorkerSlot *s = &slots[slot];
+    int64_t latency;
+
+    if (!s->requested_at ||
+        __atomic_load_n(&s->state, __ATOMIC_ACQUIRE) != CHANNEL_PARKED)
+        return;
+
+    if ((latency = s->parked_at - s->requested_at) >= 0)
+    {
+        park_total += latency;
+        if (latency > park_max)
+            park_max = latency;
+        park_count++;
+    }
+    s->requested_at = 0;
+}
+
+/*
+DESCRIPTION:
+    - Creates the shared region with room for `CHANNEL_MAX_SLOTS` workers.
+
+RETURNS:
+    + TRUE if the region is mapped.
+    + FALSE otherwise.
+*/
+char initializeChannel()
+{
+    size_t size = CHANNEL_MAX_SLOTS * sizeof(WorkerSlot);
+    int i;
+
+    /*
+    NOTE:
+        - The descriptor is deliberately inheritable.
+    */
+    if ((channel_fd = memfd_create("mlq-channel", 0)) < 0 ||
+        ftruncate(channel_fd, size) < 0 ||
+        (slots = (WorkerSlot *)mmap(NULL, size, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED, channel_fd, 0)) == MAP_FAILED)
+    {
+        fprintf(stderr, "ERROR: Could not create worker control channel\n");
+        slots = NULL;
+        return FALSE;
+    }
+
+    for (i = CHANNEL_MAX_SLOTS - 1; i >= 0; i--)
+        free_slots[free_count++] = i;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Takes a free slot for a worker about to be launched and writes the
+    argument that tells the worker where it is to `arg`, which must have room
+    for `CHANNEL_ARG_MAX` characters.
+
+RETURNS:
+    + The slot index.
+    + CHANNEL_NO_SLOT if there is no channel or every slot is taken.
+*/
+int openSlot(char *arg)
+{
+    int slot, i;
+
+    if (!slots)
+        return CHANNEL_NO_SLOT;
+
+    for (i = retiring_count - 1; i >= 0; i--)
+    {
+        if (!isChildAlive(slots[retiring[i]].pid))
+        {
+            free_slots[free_count++] = retiring[i];
+            retiring[i] = retiring[--retiring_count];
+        }
+    }
+
+    if (!free_count)
+        return CHANNEL_NO_SLOT;
+
+    slot = free_slots[--free_count];
+    slots[slot].control = CHANNEL_RUN;
+    slots[slot].state = CHANNEL_RUNNING;
+    slots[slot].progress = 0;
+    slots[slot].requested_at = 0;
+    slots[slot].parked_at = 0;
+    slots[slot].pid = 0;
+    snprintf(arg, CHANNEL_ARG_MAX, "%d:%d", channel_fd, slot);
+
+    return slot;
+}
+
+/*
+DESCRIPTION:
+    - Records the worker launched for slot `slot`. A pid below one means the
+    launch failed and the slot is given back.
+
+RETURNS:
+    + Nothing.
+*/
+void bindSlot(int slot, pid_t pid)
+{
+    if (pid <= 0)
+    {
+        free_slots[free_count++] = slot;
+        return;
+    }
+
+    slots[slot].pid = pid;
+}
+
+/*
+DESCRIPTION:
+    - Asks the worker in slot `slot` to park. This does not wait, the worker
+    parks at its next check of the control word. A worker sleeping on the
+    control word is woken so that it checks straight away.
+
+RETURNS:
+    + Nothing.
+*/
+void parkSlot(int slot)
+{
+    slots[slot].requested_at = monotonicNanos();
+    __atomic_store_n(&slots[slot].control, CHANNEL_PARK, __ATOMIC_RELEASE);
+    wakeSlot(slot);
+}
+
+/*
+DESCRIPTION:
+    - Lets the worker in slot `slot` run again.
+
+RETURNS:
+    + Nothing.
+*/
+void unparkSlot(int slot)
+{
+    collectParkLatency(slot);
+    __atomic_store_n(&slots[slot].control, CHANNEL_RUN, __ATOMIC_RELEASE);
+    wakeSlot(slot);
+}
+
+/*
+DESCRIPTION:
+    - Asks the worker in slot `slot` to exit, and retires the slot until the
+    worker is gone.
+
+RETURNS:
+    + Nothing.
+*/
+void exitSlot(int slot)
+{
+    collectParkLatency(slot);
+    __atomic_store_n(&slots[slot].control, CHANNEL_EXIT, __ATOMIC_RELEASE);
+    wakeSlot(slot);
+    retiring[retiring_count++] = slot;
+}
+
+/*
+DESCRIPTION:
+    - Prints the average and maximum time workers took to park after being
+    asked to. Prints nothing if no worker parked.
+
+RETURNS:
+    + Nothing.
+*/
+void printChannelStats()
+{
+    if (!park_count)
+        return;
+
+    printf("Channel park latency avg/max: %.1f/%.1f us over %" PRIu64
+           " parks\n",
+           (double)park_total / park_count / 1000.0, (double)park_max / 1000.0,
+           park_count);
+}
@@ -0,0 +1,414 @@
+#include <checkpoint.h>
+
+/*
+NOTE:
+    - A checkpoint is put together in `buffer` by the dispatcher, between two
+    ticks, and written out on a thread of its own while the dispatcher goes
+    on. The file is written under a temporary name, synced and then renamed
+    over the last one, so whatever happens on the way there is always one
+    whole checkpoint at `checkpoint_path`. The buffer is left alone while
+    the writer has it, and a checkpoint that comes due in the meantime is
+    skipped rather than waited for.
+*/
+static char *checkpoint_path = NULL;
+static char *temp_path = NULL;
+static char *directory = NULL;
+
+static unsigned char *buffer = NULL;
+static size_t length = 0;
+static size_t capacity = 0;
+static char building = FALSE;
+
+static pthread_t writer_thread;
+static char writer_started = FALSE;
+static char writing = FALSE;
+
+static unsigned char *loaded = NULL;
+static size_t loaded_size = 0;
+static size_t loaded_at = 0;
+
+static uint64_t written = 0;
+static uint64_t skipped = 0;
+static uint64_t failed = 0;
+static int64_t write_ns = 0;
+
+/*
+DESCRIPTION:
+    - Hashes the `size` bytes at `data` with 64-bit FNV-1a.
+
+RETURNS:
+    + The hash.
+*/
+static uint64_t hashBytes(const unsigned char *data, size_t size)
+{
+    uint64_t hash = CHECKPOINT_FNV_OFFSET;
+    size_t i;
+
+    for (i = 0; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= CHECKPOINT_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/*
+DESCRIPTION:
+    - Writes the whole buffer to the temporary file, syncs it, renames it over
+    the checkpoint and syncs the directory, so that the rename itself also
+    survives a crash.
+
+RETURNS:
+    + TRUE if the checkpoint is on disk.
+    + FALSE if not, after printing why.
+*/
+static char saveBuffer()
+{
+    size_t done = 0;
+    ssize_t n;
+    int fd;
+
+    if ((fd = open(temp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                   0644)) < 0)
+    {
+        fprintf(stderr, "WARNING: Could not create \"%s\": %s\n", temp_path,
+                strerror(errno));
+        return FALSE;
+    }
+
+    while (done < length)
+    {
+        if ((n = write(fd, buffer + done, length - done)) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        done += (size_t)n;
+    }
+    if (done < length || fsync(fd) < 0)
+    {
+        fprintf(stderr, "WARNING: Could not write \"%s\": %s\n", temp_path,
+                strerror(errno));
+        close(fd);
+        return FALSE;
+    }
+    close(fd);
+
+    if (rename(temp_path, checkpoint_path) < 0)
+    {
+        fprintf(stderr, "WARNING: Could not replace \"%s\": %s\n",
+                checkpoint_path, strerror(errno));
+        return FALSE;
+    }
+    if ((fd = open(directory, O_RDONLY | O_DIRECTORY | O_CLOEXEC)) >= 0)
+    {
+        fsync(fd);
+        close(fd);
+    }
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Body of the writer thread. Fills in the header, so that the dispatcher
+    does not spend its time hashing, and saves the buffer.
+
+RETURNS:
+    + NULL.
+*/
+static void *writeCheckpoint(void *unused)
+{
+    CheckpointHeader header;
+    int64_t start = monotonicNanos();
+
+    (void)unused;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE);
+    header.version = CHECKPOINT_VERSION;
+    header.size = length - sizeof(header);
+    header.checksum = hashBytes(buffer + sizeof(header), header.size);
+    memcpy(buffer, &header, sizeof(header));
+
+    if (saveBuffer())
+    {
+        written++;
+        write_ns += monotonicNanos() - start;
+    }
+    else
+    {
+        failed++;
+    }
+    __atomic_store_n(&writing, FALSE, __ATOMIC_RELEASE);
+
+    return NULL;
+}
+
+/*
+DESCRIPTION:
+    - Has checkpoints written to `path`. The temporary file they are written
+    to first sits next to it, so that the rename never crosses file systems.
+
+RETURNS:
+    + TRUE if checkpoints can be taken.
+    + FALSE if memory ran out.
+*/
+char configureCheckpoint(const char *path)
+{
+    char *copy;
+
+    if (!(checkpoint_path = strdup(path)) ||
+        !(temp_path = malloc(strlen(path) +
+                             sizeof(CHECKPOINT_TEMP_SUFFIX))) ||
+        !(copy = strdup(path)) ||
+        !(buffer = malloc(CHECKPOINT_INITIAL_CAPACITY)))
+    {
+        fprintf(stderr, "ERROR: Could not set up checkpoints\n");
+        return FALSE;
+    }
+    strcpy(temp_path, path);
+    strcat(temp_path, CHECKPOINT_TEMP_SUFFIX);
+    directory = strdup(dirname(copy));
+    free(copy);
+    capacity = CHECKPOINT_INITIAL_CAPACITY;
+
+    return directory != NULL;
+}
+
+/*
+DESCRIPTION:
+    - Starts a new checkpoint, once the last one is on disk. Only the dis-
+    patcher calls this.
+
+RETURNS:
+    + TRUE if the checkpoint can be put together with `putCheckpoint()`.
+    + FALSE if there is nowhere to write it, or the last one is still being
+    written, in which case this one is skipped.
+*/
+char beginCheckpoint()
+{
+    if (!checkpoint_path)
+        return FALSE;
+
+    if (writer_started)
+    {
+        if (__atomic_load_n(&writing, __ATOMIC_ACQUIRE))
+        {
+            skipped++;
+            return FALSE;
+        }
+        pthread_join(writer_thread, NULL);
+        writer_started = FALSE;
+    }
+
+    length = sizeof(CheckpointHeader);
+    building = TRUE;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Adds the `size` bytes at `data` to the checkpoint being put together.
+
+RETURNS:
+    + TRUE if they were added.
+    + FALSE if memory ran out, in which case the checkpoint is dropped.
+*/
+char putCheckpoint(const void *data, size_t size)
+{
+    unsigned char *grown;
+    size_t needed = length + size;
+
+    if (!building)
+        return FALSE;
+
+    if (needed > capacity)
+    {
+        while (capacity < needed)
+            capacity *= 2;
+        if (!(grown = realloc(buffer, capacity)))
+        {
+            fprintf(stderr, "WARNING: Could not grow the checkpoint\n");
+            building = FALSE;
+            failed++;
+            return FALSE;
+        }
+        buffer = grown;
+    }
+
+    memcpy(buffer + length, data, size);
+    length = needed;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Hands the checkpoint that has been put together to the writer thread.
+
+RETURNS:
+    + Nothing.
+*/
+void commitCheckpoint()
+{
+    sigset_t all, old;
+    int error;
+
+    if (!building)
+        return;
+    building = FALSE;
+
+    /*
+    NOTE:
+        - The writer blocks every signal, like the trace reader, so that the
+        dispatcher's signals are never delivered to it.
+    */
+    __atomic_store_n(&writing, TRUE, __ATOMIC_RELEASE);
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    error = pthread_create(&writer_thread, NULL, writeCheckpoint, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (error)
+    {
+        fprintf(stderr, "WARNING: Could not start the checkpoint writer: %s\n",
+                strerror(error));
+        __atomic_store_n(&writing, FALSE, __ATOMIC_RELAXED);
+        failed++;
+        return;
+    }
+    writer_started = TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Waits for the checkpoint being written, if any, and lets go of a loaded
+    checkpoint.
+
+RETURNS:
+    + Nothing.
+*/
+void closeCheckpoint()
+{
+    if (writer_started)
+    {
+        pthread_join(writer_thread, NULL);
+        writer_started = FALSE;
+    }
+
+    free(loaded);
+    loaded = NULL;
+    loaded_size = loaded_at = 0;
+}
+
+/*
+DESCRIPTION:
+    - Reads the checkpoint at `path` into memory, for `getCheckpoint()` to
+    take apart. It is only accepted whole and unchanged.
+
+RETURNS:
+    + TRUE if the checkpoint was loaded.
+    + FALSE if not, after printing why.
+*/
+char loadCheckpoint(const char *path)
+{
+    CheckpointHeader header;
+    const char *reason = NULL;
+    FILE *file;
+
+    if (!(file = fopen(path, "rb")))
+    {
+        fprintf(stderr, "ERROR: Could not read checkpoint \"%s\": %s\n", path,
+                strerror(errno));
+        return FALSE;
+    }
+
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, CHECKPOINT_MAGIC, CHECKPOINT_MAGIC_SIZE))
+        reason = "not a checkpoint";
+    else if (header.version != CHECKPOINT_VERSION)
+        reason = "from another version of the dispatcher";
+    else if (!(loaded = malloc(header.size ? header.size : 1)))
+        reason = "too large to load";
+    else if (fread(loaded, 1, header.size, file) != header.size)
+        reason = "cut short";
+    else if (hashBytes(loaded, header.size) != header.checksum)
+        reason = "damaged";
+    fclose(file);
+
+    if (reason)
+    {
+        fprintf(stderr, "ERROR: Checkpoint \"%s\" is %s\n", path, reason);
+        free(loaded);
+        loaded = NULL;
+        return FALSE;
+    }
+    loaded_size = header.size;
+    loaded_at = 0;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Takes the next `size` bytes of the loaded checkpoint into `data`.
+
+RETURNS:
+    + TRUE if there were that many left.
+    + FALSE otherwise.
+*/
+char getCheckpoint(void *data, size_t size)
+{
+    if (!loaded || loaded_size - loaded_at < size)
+        return FALSE;
+
+    memcpy(data, loaded + loaded_at, size);
+    loaded_at += size;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Finds how much of the loaded checkpoint has not been taken yet.
+
+RETURNS:
+    + The number of bytes left.
+*/
+size_t checkpointLeft()
+{
+    return loaded_size - loaded_at;
+}
+
+/*
+DESCRIPTION:
+    - Prints how many checkpoints were written, how long the writer took over
+    each and how many were skipped or lost. Prints nothing if checkpoints
+    were never taken.
+
+RETURNS:
+    + Nothing.
+*/
+void printCheckpointStats()
+{
+    if (!written && !failed && !skipped)
+        return;
+
+    printf("Checkpoints written: %" PRIu64 " (%.3f ms each, last %zu bytes)\n",
+           written,
+           written ? (double)write_ns / (double)written /
+                         (double)EVENT_NANOS_PER_MILLI
+                   : 0.0,
+           length);
+    if (skipped)
+    {
+        printf("Checkpoints skipped while writing: %" PRIu64 "\n", skipped);
+    }
+    if (failed)
+    {
+        printf("Checkpoints failed: %" PRIu64 "\n", failed);
+    }
+}
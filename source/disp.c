@@ -7,7 +7,9 @@ int main(int argc, char *argv[])
         - Queue declarations and initializations. Along with other miscellaneous
         declarations.
     */
-    Block *jobs = NULL, *zero = NULL, *one = NULL, *two = NULL;
+    JobTable *jobs = NULL;
+    Block *zero = NULL, *one = NULL, *two = NULL;
+    DeadlineHeap *edf = NULL;
     Block *current_process = NULL;
     Block *process = NULL;
     uint64_t n = 0;
@@ -24,61 +26,255 @@ int main(int argc, char *argv[])
         fprintf(stderr, "FATAL: Bad arguments array\n");
         exit(EXIT_FAILURE);
     }
-    else if (argc != ARGS_EXACT_COUNT)
+    else if (!parseArguments(argc, argv) ||
+             !configureIsolation(options.dispatcher_cpu, options.job_cpus,
+                                 options.lock_memory, options.realtime))
     {
-        fprintf(stderr, "USAGE: %s <TESTFILE>\n", argv[0]);
         exit(EXIT_FAILURE);
     }
 
+    /*
+    NOTE:
+        - Stress mode does not schedule anything, it only exercises the child
+        supervision machinery at scale.
+    */
+    if (options.stress_count > 0)
+    {
+        process = createNullBlock();
+        if (!process || !initializeEventLoop(options.tick_ms,
+                                             options.switch_timeout_ms) ||
+            !configureSpawn(options.launch_method,
+                            blockInfo(process)->args[PCB_ARGS_PNAME]) ||
+            !silenceSpawnOutput())
+        {
+            exit(EXIT_FAILURE);
+        }
+        if (options.block_stress)
+        {
+            runQueueStress(options.stress_count);
+        }
+        else if (options.executor == PCB_EXEC_FIBER)
+        {
+            configureFibers(options.fiber_kernel, options.fiber_guard);
+            runFiberStress(options.stress_count);
+        }
+        else
+        {
+            runStress(options.stress_count, blockInfo(process)->args);
+        }
+        freeBlock(process);
+        exit(EXIT_SUCCESS);
+    }
+
     /*
     SECTION 2: USER INPUT
     */
-    getUserInput(&t0, &t1, &t2, &W);
+    /*
+    NOTE:
+        - A run resumed from a checkpoint takes its quanta from there.
+    */
+    if (!options.restore_path)
+        getUserInput(&t0, &t1, &t2, &W);
+    if (options.adaptive)
+    {
+        configureAdaptation(options.adapt_window, options.adapt_target,
+                            options.adapt_min, options.adapt_max);
+    }
 
     /*
     SECTION 3: JOB DISPATCH QUEUE (JDQ) INITIALIZATION
     */
-    jobs = initializeJobDispatchQueue(argv[ARGS_JOBS_FILENAME]);
+    jobs = initializeJobDispatchQueue(options.jobs_filename);
     if (!jobs)
     {
-        fprintf(stderr, "ERROR: Could not open \"%s\"\n", argv[1]);
+        fprintf(stderr, "ERROR: Could not open \"%s\"\n",
+                options.jobs_filename);
+        exit(EXIT_FAILURE);
+    }
+    if (!(edf = createDeadlineHeap()))
+    {
         exit(EXIT_FAILURE);
     }
     printf("\n");
-    metrics.completed_jobs = countTotalJobs(jobs);
+
+    if (!initializeEventLoop(options.tick_ms, options.switch_timeout_ms) ||
+        !(process = createNullBlock()) ||
+        !configureSpawn(options.launch_method,
+                        blockInfo(process)->args[PCB_ARGS_PNAME]) ||
+        !initializePool(options.pool_max,
+                        blockInfo(setWorkload(process,
+                                              options.workload))->args))
+    {
+        exit(EXIT_FAILURE);
+    }
+    freeBlock(process);
+
+    /*
+    NOTE:
+        - The cgroup executor needs a writable cgroup v2 hierarchy. Without
+        one the run goes on with signals rather than failing.
+    */
+    if (options.executor == PCB_EXEC_CGROUP && !initializeCgroups())
+    {
+        fprintf(stderr, "ALERT: cgroup v2 is not writable, "
+                        "falling back to signals\n");
+        options.executor = PCB_EXEC_SIGNAL;
+    }
+    if (options.executor == PCB_EXEC_CHANNEL && !initializeChannel())
+    {
+        fprintf(stderr, "ALERT: No worker control channel, "
+                        "falling back to signals\n");
+        options.executor = PCB_EXEC_SIGNAL;
+    }
+    setExecutor(options.executor);
+    configureFibers(options.fiber_kernel, options.fiber_guard);
+    configureWatchdog(options.quarantine_after);
+
+    scheduler.jobs = jobs;
+    scheduler.edf = edf;
+    scheduler.zero = &zero;
+    scheduler.one = &one;
+    scheduler.two = &two;
+    scheduler.current_process = &current_process;
+    scheduler.timer = &timer;
+    scheduler.quanta[PCB_PRIORITY_0] = &t0;
+    scheduler.quanta[PCB_PRIORITY_1] = &t1;
+    scheduler.quanta[PCB_PRIORITY_2] = &t2;
+    scheduler.W = &W;
+    if ((options.restore_path && !restoreScheduler(options.restore_path)) ||
+        (options.checkpoint_path &&
+         !configureCheckpoint(options.checkpoint_path)))
+    {
+        exit(EXIT_FAILURE);
+    }
+    if (options.stats_path &&
+        !openStatsSocket(options.stats_path, writeStatsSnapshot))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    /*
+    NOTE:
+        - With jobs submitted at run time the dispatcher is a service. It is
+        stopped by SIGTERM or SIGINT, after which it stops taking jobs and
+        finishes the ones it has.
+    */
+    configureIngest((int64_t)options.tick_ms * EVENT_NANOS_PER_MILLI,
+                    options.workload);
+    if ((options.ingest_fifo && !openIngestFifo(options.ingest_fifo)) ||
+        (options.ingest_socket && !openIngestSocket(options.ingest_socket)))
+    {
+        exit(EXIT_FAILURE);
+    }
+    if (isIngestOpen() && (!catchSignal(SIGTERM) || !catchSignal(SIGINT)))
+    {
+        exit(EXIT_FAILURE);
+    }
+    if (options.settings_path && !catchSignal(SIGHUP))
+    {
+        exit(EXIT_FAILURE);
+    }
 
     /*
     SECTION 4: OS DISPATCHER/SCHEDULER
     */
     while (TRUE)
     {
+        reapLostJobs(&current_process, edf, &zero, &one, &two);
+        refillPool(timer);
+        sampleQueues();
+        if (options.settings_path)
+            checkAndReload(timer);
+
+        if (isIngestOpen() && (takeSignal(SIGTERM) || takeSignal(SIGINT)))
+            closeIngest();
+        metrics.completed_jobs += pullJobs(jobs, timer);
+        /*
+        NOTE:
+            - A jobs file that could not be loaded at all stops the run
+            before any of it is scheduled. One that failed part of the way
+            through is scheduled as far as it got.
+        */
+        if (readerFailed() && !takenJobs())
+        {
+            fprintf(stderr, "FATAL: Could not load the jobs file\n");
+            exit(EXIT_FAILURE);
+        }
+        metrics.completed_jobs += drainIngest(jobs, timer);
+        if (options.checkpoint_path)
+            checkAndCheckpoint(timer);
+
+        /*
+        NOTE:
+            - In the kernel-delegated mode the kernel does the time slicing
+            and this loop only moves jobs between levels.
+        */
+        if (options.delegated)
+        {
+            if (!delegateTick(jobs, edf, &zero, &one, &two, t0, t1, W,
+                              &timer))
+                break;
+            continue;
+        }
+
         /*
         NOTE:
-            - There are still jobs in the JDQ.
+            - There are still jobs in the JDQ, or more may be submitted.
         */
-        if (countTotalJobs(jobs))
+        if (pendingJobs(jobs) || isIngestOpen())
         {
-            queueFromDispatch(&jobs, &zero, &one, &two, timer);
+            queueFromDispatch(jobs, edf, &zero, &one, &two, timer);
             /*
             NOTE:
                 - If nothing are in the other queues then we just idle wait for
                 processes to come while increasing the timer.
             */
-            if (!countTotalJobs(zero) && !countTotalJobs(one) &&
-                !countTotalJobs(two))
+            if (!peekDeadline(edf) && !countTotalJobs(zero) &&
+                !countTotalJobs(one) && !countTotalJobs(two))
             {
                 /*
                 NOTE:
                     - Increase the timer.
                 */
-                timer++;
-                sleep(UNIT_CPU_TIME_SIM);
+                idleCycle(jobs, &timer);
                 continue;
             }
         }
 
+        /*
+        NOTE:
+            - Re-tuning the quanta from what was seen since the last pass. The
+            new values take effect at the next quantum check.
+        */
+        if (options.adaptive)
+        {
+            adaptQuantum(PCB_PRIORITY_0, &t0, timer);
+            adaptQuantum(PCB_PRIORITY_1, &t1, timer);
+            adaptQuantum(PCB_PRIORITY_2, &t2, timer);
+        }
+
         checkAndHandleStarvation(&zero, &one, &two, timer, W);
 
+        /*
+        NOTE:
+            - Handling the EDF class. It sits above level-0, so whatever is
+            running gets preempted by `checkAndRunProcess()` as soon as a dea-
+            dline job is at the top of the heap. There is no quantum here, a
+            job runs until it finishes or an earlier deadline arrives.
+        */
+        if (peekDeadline(edf))
+        {
+            checkAndRunProcess(&current_process, peekDeadline(edf), timer);
+            updateCycle(&current_process, jobs, &timer);
+
+            if (!checkAndTerminateDeadline(&current_process, edf, timer))
+            {
+                queueFromDispatch(jobs, edf, &zero, &one, &two, timer);
+            }
+
+            continue;
+        }
+
         /*
         NOTE:
             - Handling level-0 queue.
@@ -86,11 +282,11 @@ int main(int argc, char *argv[])
         if (countTotalJobs(zero))
         {
             checkAndRunProcess(&current_process, zero, timer);
-            updateCycle(&current_process, &timer);
+            updateCycle(&current_process, jobs, &timer);
 
             if (!checkAndTerminate(&current_process, &zero, timer))
             {
-                queueFromDispatch(&jobs, &zero, &one, &two, timer);
+                queueFromDispatch(jobs, edf, &zero, &one, &two, timer);
                 checkAndDemote(&current_process, t0, &zero, &one, PCB_PRIORITY_1,
                                timer);
             }
@@ -105,11 +301,11 @@ int main(int argc, char *argv[])
         if (countTotalJobs(one))
         {
             checkAndRunProcess(&current_process, one, timer);
-            updateCycle(&current_process, &timer);
+            updateCycle(&current_process, jobs, &timer);
 
             if (!checkAndTerminate(&current_process, &one, timer))
             {
-                queueFromDispatch(&jobs, &zero, &one, &two, timer);
+                queueFromDispatch(jobs, edf, &zero, &one, &two, timer);
                 checkAndDemote(&current_process, t1, &one, &two, PCB_PRIORITY_2,
                                timer);
             }
@@ -124,11 +320,11 @@ int main(int argc, char *argv[])
         if (countTotalJobs(two))
         {
             checkAndRunProcess(&current_process, two, timer);
-            updateCycle(&current_process, &timer);
+            updateCycle(&current_process, jobs, &timer);
 
             if (!checkAndTerminate(&current_process, &two, timer))
             {
-                queueFromDispatch(&jobs, &zero, &one, &two, timer);
+                queueFromDispatch(jobs, edf, &zero, &one, &two, timer);
                 checkAndDemote(&current_process, t2, &two, &two, PCB_PRIORITY_2,
                                timer);
             }
@@ -138,8 +334,81 @@ int main(int argc, char *argv[])
 
         break;
     }
+    drainPool();
+    awaitChildren();
+    cleanupCgroups();
+    closeStatsSocket();
+    closeIngest();
+    closeReader();
+    closeCheckpoint();
 
     printf("Average turnaround time: %.3f\n", ((float)metrics.total_turnaround / ((float)metrics.completed_jobs)));
     printf("Average waiting time: %.3f\n", ((float)metrics.total_waiting / (float)metrics.completed_jobs));
-    printf("Average response time: %.3f\n", ((float)metrics.total_response / (float)metrics.completed_jobs));
+    printf("Average response time: %.3f\n", ((float)metrics.total_response / (float)metrics.responded_jobs));
+    printf("Throughput: %.3f jobs per time unit over %" PRIu64 " units\n",
+           timer ? (float)metrics.completed_jobs / (float)timer : 0.0f, timer);
+
+    printSpawnLatency();
+    printPoolStats();
+    printTickJitter();
+    printWatchdogStats();
+    printChannelStats();
+    printFiberStats();
+    printStatsServed();
+    printIngestStats();
+    printCheckpointStats();
+    if (metrics.reloads || metrics.rejected_reloads)
+    {
+        printf("Settings reloaded: %" PRIu64 " (%" PRIu64 " rejected)\n",
+               metrics.reloads, metrics.rejected_reloads);
+    }
+    printf("Context switches elided: %" PRIu64 "\n", metrics.elided_switches);
+    if (metrics.started_jobs)
+    {
+        printf("Average start latency from arrival: %.3f ms (%.3f units)\n",
+               (double)metrics.start_latency_ns /
+                   (double)metrics.started_jobs / 1000000.0,
+               (double)metrics.start_latency_ns /
+                   (double)metrics.started_jobs /
+                   ((double)options.tick_ms * 1000000.0));
+    }
+    if (metrics.cut_ticks)
+    {
+        printf("Ticks cut short by arrivals: %" PRIu64 "\n",
+               metrics.cut_ticks);
+    }
+    if (options.accounting == ACCOUNT_CPU && metrics.running_ticks)
+    {
+        printf("CPU consumed per dispatched tick: %.3f units\n",
+               (double)metrics.charged_ns / (double)metrics.running_ticks /
+                   ((double)options.tick_ms * 1000000.0));
+    }
+    if (metrics.measured_jobs)
+    {
+        printf("Measured CPU time per job (cpu.stat): %.3f ms\n",
+               (double)metrics.measured_cpu_usec /
+                   (double)metrics.measured_jobs / 1000.0);
+    }
+    if (metrics.deferred_launches)
+    {
+        printf("Launches deferred at the process limit: %" PRIu64 "\n",
+               metrics.deferred_launches);
+    }
+    if (metrics.lost_jobs)
+    {
+        printf("Jobs lost to unexpected exits: %" PRIu64 "\n",
+               metrics.lost_jobs);
+    }
+    printReaderStats();
+    printQuarantine();
+
+    if (metrics.deadline_jobs)
+    {
+        printf("Deadline jobs: %" PRIu64 " (%" PRIu64 " rejected, %" PRIu64
+               " flagged infeasible)\n",
+               metrics.deadline_jobs, metrics.deadline_rejected,
+               metrics.deadline_flagged);
+        printf("Deadline misses: %" PRIu64 "\n", metrics.deadline_misses);
+        printSlackDistribution();
+    }
 }
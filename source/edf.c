@@ -0,0 +1,348 @@
+#include <edf.h>
+
+/*
+NOTE:
+    - Slack of every completed deadline job. Kept around until the end of the
+    run so the distribution can be reported along with the other metrics.
+*/
+static int *slacks = NULL;
+static int slack_count = 0;
+static int slack_capacity = 0;
+
+/*
+DESCRIPTION:
+    - Orders two blocks by absolute deadline. Ties are broken by arrival time
+    so that jobs with the same deadline are served in the order they came in.
+
+RETURNS:
+    + TRUE if `a` should run before `b`.
+    + FALSE otherwise.
+*/
+static char isEarlier(Block *a, Block *b)
+{
+    if (a->deadline != b->deadline)
+        return a->deadline < b->deadline;
+
+    return a->arrival_time < b->arrival_time;
+}
+
+/*
+DESCRIPTION:
+    - Compares two blocks by deadline for `qsort()`.
+
+RETURNS:
+    + Negative, zero or positive as per `qsort()` conventions.
+*/
+static int compareDeadlines(const void *a, const void *b)
+{
+    Block *x = *(Block **)a;
+    Block *y = *(Block **)b;
+
+    if (isEarlier(x, y))
+        return -1;
+    if (isEarlier(y, x))
+        return 1;
+
+    return 0;
+}
+
+/*
+DESCRIPTION:
+    - Compares two integers for `qsort()`.
+
+RETURNS:
+    + Negative, zero or positive as per `qsort()` conventions.
+*/
+static int compareInts(const void *a, const void *b)
+{
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+DESCRIPTION:
+    - Moves `p` up from slot `i` until its parent runs no later than it does.
+
+RETURNS:
+    + Nothing.
+*/
+static void siftUp(DeadlineHeap *h, int i, Block *p)
+{
+    int parent;
+
+    while (i > 0)
+    {
+        parent = (i - 1) / 2;
+        if (!isEarlier(p, h->heap[parent]))
+            break;
+        h->heap[i] = h->heap[parent];
+        i = parent;
+    }
+    h->heap[i] = p;
+}
+
+/*
+DESCRIPTION:
+    - Moves `p` down from slot `i` until neither child runs earlier than it.
+
+RETURNS:
+    + Nothing.
+*/
+static void siftDown(DeadlineHeap *h, int i, Block *p)
+{
+    int child;
+
+    while ((child = 2 * i + 1) < h->size)
+    {
+        if (child + 1 < h->size && isEarlier(h->heap[child + 1], h->heap[child]))
+            child++;
+        if (!isEarlier(h->heap[child], p))
+            break;
+        h->heap[i] = h->heap[child];
+        i = child;
+    }
+    h->heap[i] = p;
+}
+
+/*
+DESCRIPTION:
+    - Creates an empty binary min-heap keyed on the absolute deadline.
+
+RETURNS:
+    + DeadlineHeap* of the newly created heap.
+    + NULL if failed at allocating memory.
+*/
+DeadlineHeap *createDeadlineHeap()
+{
+    DeadlineHeap *h;
+
+    if (!(h = (DeadlineHeap *)malloc(sizeof(DeadlineHeap))))
+    {
+        fprintf(stderr, "ERROR: Could not create deadline heap\n");
+        return NULL;
+    }
+
+    if (!(h->heap = (Block **)malloc(EDF_INITIAL_CAPACITY * sizeof(Block *))))
+    {
+        fprintf(stderr, "ERROR: Could not create deadline heap\n");
+        free(h);
+        return NULL;
+    }
+
+    h->size = 0;
+    h->capacity = EDF_INITIAL_CAPACITY;
+
+    return h;
+}
+
+/*
+DESCRIPTION:
+    - Inserts block `p` into the heap and sifts it up to its place. The heap
+    grows by doubling when it runs out of room.
+
+RETURNS:
+    + Block* of the inserted block.
+    + NULL if the heap could not grow.
+*/
+Block *pushDeadline(DeadlineHeap *h, Block *p)
+{
+    if (h->size == h->capacity)
+    {
+        Block **grown = (Block **)realloc(h->heap,
+                                          2 * h->capacity * sizeof(Block *));
+        if (!grown)
+        {
+            fprintf(stderr, "ERROR: Could not grow deadline heap\n");
+            return NULL;
+        }
+        h->heap = grown;
+        h->capacity *= 2;
+    }
+
+    p->next = PCB_NIL;
+    siftUp(h, h->size++, p);
+
+    return p;
+}
+
+/*
+DESCRIPTION:
+    - Removes the block with the earliest deadline and sifts the last element
+    down from the root to restore the heap property.
+
+RETURNS:
+    + Block* with the earliest deadline.
+    + NULL if the heap was empty.
+*/
+Block *popDeadline(DeadlineHeap *h)
+{
+    Block *top, *last;
+
+    if (!h || !h->size)
+        return NULL;
+
+    top = h->heap[0];
+    last = h->heap[--h->size];
+    if (h->size)
+        siftDown(h, 0, last);
+
+    return top;
+}
+
+/*
+DESCRIPTION:
+    - Removes block `p` from anywhere in the heap. This is for deadline jobs
+    that have to leave the EDF class out of turn.
+
+RETURNS:
+    + Block* of the removed block.
+    + NULL if the block was not in the heap.
+*/
+Block *removeDeadline(DeadlineHeap *h, Block *p)
+{
+    Block *last;
+    int i;
+
+    for (i = 0; h && i < h->size; i++)
+    {
+        if (h->heap[i] != p)
+            continue;
+
+        last = h->heap[--h->size];
+        if (i < h->size)
+        {
+            siftDown(h, i, last);
+            siftUp(h, i, h->heap[i]);
+        }
+        return p;
+    }
+
+    return NULL;
+}
+
+/*
+DESCRIPTION:
+    - Looks at the block with the earliest deadline without removing it.
+
+RETURNS:
+    + Block* with the earliest deadline.
+    + NULL if the heap was empty.
+*/
+Block *peekDeadline(DeadlineHeap *h)
+{
+    if (!h || !h->size)
+        return NULL;
+
+    return h->heap[0];
+}
+
+/*
+DESCRIPTION:
+    - Admission test. Checks whether every job already in the heap, together
+    with the candidate `p`, can still meet its deadline when run back to back
+    in deadline order starting at `timer`. On a single CPU this is exact for
+    EDF: if the deadline-ordered schedule misses, every schedule misses.
+
+    - Only the misses `p` causes count against it. A job already bound to
+    miss its deadline without `p` would otherwise get every later job flag-
+    ged or rejected, however easily it fits. Jobs ordered before `p` finish
+    at the same time either way, and a job after it only misses because of
+    it if it would have made its deadline `p`'s remaining time earlier.
+
+RETURNS:
+    + TRUE if admitting `p` makes no job miss its deadline that would not
+    have missed it anyway.
+    + FALSE if `p`, or some job it delays, would miss its deadline.
+*/
+char isFeasibleWith(DeadlineHeap *h, Block *p, uint64_t timer)
+{
+    Block **order;
+    uint64_t finish = timer;
+    char feasible = TRUE, after = FALSE;
+    int i;
+
+    if (!(order = (Block **)malloc((h->size + 1) * sizeof(Block *))))
+    {
+        fprintf(stderr, "ERROR: Could not run deadline admission test\n");
+        return FALSE;
+    }
+
+    for (i = 0; i < h->size; i++)
+        order[i] = h->heap[i];
+    order[h->size] = p;
+    qsort(order, h->size + 1, sizeof(Block *), compareDeadlines);
+
+    for (i = 0; i <= h->size; i++)
+    {
+        finish += order[i]->remaining_cpu_time;
+        if ((int64_t)finish > order[i]->deadline &&
+            (order[i] == p ||
+             (after && (int64_t)(finish - p->remaining_cpu_time) <=
+                           order[i]->deadline)))
+        {
+            feasible = FALSE;
+            break;
+        }
+        if (order[i] == p)
+            after = TRUE;
+    }
+
+    free(order);
+
+    return feasible;
+}
+
+/*
+DESCRIPTION:
+    - Records the slack (deadline minus completion time) of a finished dead-
+    line job. Negative slack is a deadline miss.
+
+RETURNS:
+    + Nothing.
+*/
+void recordSlack(int slack)
+{
+    if (slack_count == slack_capacity)
+    {
+        int capacity = slack_capacity ? 2 * slack_capacity
+                                       : EDF_SLACK_INITIAL_CAPACITY;
+        int *grown = (int *)realloc(slacks, capacity * sizeof(int));
+        if (!grown)
+        {
+            fprintf(stderr, "ERROR: Could not record deadline slack\n");
+            return;
+        }
+        slacks = grown;
+        slack_capacity = capacity;
+    }
+
+    slacks[slack_count++] = slack;
+}
+
+/*
+DESCRIPTION:
+    - Prints the minimum, percentiles, maximum and mean of the recorded slack
+    values. Prints nothing if no deadline job has completed.
+
+RETURNS:
+    + Nothing.
+*/
+void printSlackDistribution()
+{
+    int64_t sum = 0;
+    int i;
+
+    if (!slack_count)
+        return;
+
+    qsort(slacks, slack_count, sizeof(int), compareInts);
+    for (i = 0; i < slack_count; i++)
+        sum += slacks[i];
+
+    printf("Deadline slack min/p50/p90/max: %d/%d/%d/%d\n", slacks[0],
+           slacks[(slack_count - 1) / 2], slacks[(slack_count - 1) * 9 / 10],
+           slacks[slack_count - 1]);
+    printf("Average deadline slack: %.3f\n", (float)sum / (float)slack_count);
+}
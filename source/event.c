@@ -0,0 +1,1021 @@
+#include <event.h>
+
+/*
+NOTE:
+    - The event loop multiplexes the tick timer and SIGCHLD notifications on a
+    single epoll instance. SIGCHLD is blocked and read through a signalfd, so
+    stops, continues and exits of children are all picked up while waiting
+    for the next tick instead of in a blocking `waitpid()`.
+*/
+static int epoll_fd = -1;
+static int signal_fd = -1;
+static int timer_fd = -1;
+static int arrival_fd = -1;
+static char arrival_armed = FALSE;
+static char arrival_due = FALSE;
+static int64_t switch_timeout = EVENT_DEFAULT_TIMEOUT_MS * EVENT_NANOS_PER_MILLI;
+
+/*
+NOTE:
+    - Other descriptors watched by the same epoll instance on behalf of other
+    modules, with the handler to call when each is ready. They are served
+    whenever the dispatcher waits, so they never hold up a tick.
+*/
+static int watched_fds[EVENT_MAX_WATCHED];
+static void (*watched_handlers[EVENT_MAX_WATCHED])(int);
+static int watched_count = 0;
+
+/*
+NOTE:
+    - Signals other than SIGCHLD that the dispatcher asked to be told about.
+    They are read through the same signalfd and noted until someone takes
+    them.
+*/
+static sigset_t signal_mask;
+static sigset_t caught;
+
+/*
+NOTE:
+    - Tick jitter is how late the dispatcher wakes up after the timer expired,
+    measured against the timer's own schedule.
+*/
+static int64_t tick_period = 0;
+static int64_t next_tick = 0;
+static uint64_t jitter_count = 0;
+static double jitter_total = 0.0;
+static double jitter_squares = 0.0;
+static int64_t jitter_max = 0;
+static int64_t jitter_last = 0;
+
+/*
+NOTE:
+    - Supervised children live in an open-addressed hash table keyed on pid
+    with linear probing. A pid of zero marks a free slot. The capacity is a
+    power of two and is kept at most half full, so finding the block of a
+    reaped pid stays constant time with tens of thousands of children.
+*/
+static Child *children = NULL;
+static int child_count = 0;
+static int child_capacity = 0;
+static int pending_count = 0;
+
+static Block **lost = NULL;
+static int lost_count = 0;
+static int lost_capacity = 0;
+
+/*
+NOTE:
+    - The watchdog. An overdue confirmation is escalated to a signal that
+    cannot be caught or blocked, one step at a time, and counted against the
+    child's job. A job that times out `quarantine_after` times is killed and
+    handed back like a lost job.
+*/
+static int quarantine_after = EVENT_NO_QUARANTINE;
+static uint64_t timeout_count = 0;
+static uint64_t escalation_count = 0;
+static uint64_t quarantine_count = 0;
+
+/*
+DESCRIPTION:
+    - Reads the monotonic clock.
+
+RETURNS:
+    + The current monotonic time in nanoseconds.
+*/
+int64_t monotonicNanos()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (int64_t)now.tv_sec * EVENT_NANOS_PER_SECOND + now.tv_nsec;
+}
+
+/*
+DESCRIPTION:
+    - Hashes a process ID onto a slot of the child table.
+
+RETURNS:
+    + The home slot of `pid`.
+*/
+static int hashPid(pid_t pid)
+{
+    return (int)(((uint32_t)pid * EVENT_HASH_MULTIPLIER) &
+                 (uint32_t)(child_capacity - 1));
+}
+
+/*
+DESCRIPTION:
+    - Finds the supervised child with process ID `pid`.
+
+RETURNS:
+    + Child* of the entry.
+    + NULL if the process is not supervised.
+*/
+static Child *findChild(pid_t pid)
+{
+    int i;
+
+    if (!child_capacity)
+        return NULL;
+
+    for (i = hashPid(pid); children[i].pid; i = (i + 1) & (child_capacity - 1))
+    {
+        if (children[i].pid == pid)
+            return &children[i];
+    }
+
+    return NULL;
+}
+
+/*
+DESCRIPTION:
+    - Changes what confirmation a child is expected to send, keeping count of
+    how many children have one outstanding.
+
+RETURNS:
+    + Nothing.
+*/
+static void setPending(Child *c, int pending)
+{
+    if (c->pending == EVENT_PENDING_NONE && pending != EVENT_PENDING_NONE)
+        pending_count++;
+    else if (c->pending != EVENT_PENDING_NONE && pending == EVENT_PENDING_NONE)
+        pending_count--;
+
+    c->pending = pending;
+}
+
+/*
+DESCRIPTION:
+    - Drops the supervision entry of a child that has been reaped. Entries
+    further along the probe sequence are shifted back into the hole, so no
+    tombstones are needed.
+
+RETURNS:
+    + Nothing.
+*/
+static void forgetChild(Child *c)
+{
+    int mask = child_capacity - 1;
+    int hole = (int)(c - children), i = hole, home;
+
+    setPending(c, EVENT_PENDING_NONE);
+
+    while (TRUE)
+    {
+        i = (i + 1) & mask;
+        if (!children[i].pid)
+            break;
+
+        home = hashPid(children[i].pid);
+        if ((hole <= i) ? (hole < home && home <= i)
+                        : (hole < home || home <= i))
+            continue;
+
+        children[hole] = children[i];
+        hole = i;
+    }
+
+    children[hole].pid = 0;
+    child_count--;
+}
+
+/*
+DESCRIPTION:
+    - Doubles the child table and re-inserts every entry.
+
+RETURNS:
+    + TRUE if the table grew.
+    + FALSE if failed at allocating memory.
+*/
+static char growChildren()
+{
+    Child *old = children;
+    int old_capacity = child_capacity, i, j;
+    int capacity = child_capacity ? 2 * child_capacity : EVENT_INITIAL_CHILDREN;
+
+    if (!(children = (Child *)calloc(capacity, sizeof(Child))))
+    {
+        children = old;
+        return FALSE;
+    }
+    child_capacity = capacity;
+
+    for (i = 0; i < old_capacity; i++)
+    {
+        if (!old[i].pid)
+            continue;
+        for (j = hashPid(old[i].pid); children[j].pid;
+             j = (j + 1) & (child_capacity - 1))
+            ;
+        children[j] = old[i];
+    }
+    free(old);
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Counts the children that are still supervised.
+
+RETURNS:
+    + The number of live children.
+*/
+int countChildren()
+{
+    return child_count;
+}
+
+/*
+DESCRIPTION:
+    - Hands a block whose process died on its own to the dispatcher, which
+    will take it out of whatever queue it is in.
+
+RETURNS:
+    + Nothing.
+*/
+static void reportLost(Block *p)
+{
+    if (lost_count == lost_capacity)
+    {
+        int capacity = lost_capacity ? 2 * lost_capacity
+                                     : EVENT_INITIAL_CHILDREN;
+        Block **grown = (Block **)realloc(lost, capacity * sizeof(Block *));
+        if (!grown)
+        {
+            fprintf(stderr, "ERROR: Could not record lost process\n");
+            return;
+        }
+        lost = grown;
+        lost_capacity = capacity;
+    }
+
+    lost[lost_count++] = p;
+}
+
+/*
+DESCRIPTION:
+    - Sets up the epoll instance with a periodic tick timer of `tick_ms` mil-
+    liseconds and a signalfd for SIGCHLD. Context switches that are not con-
+    firmed by the child within `timeout_ms` milliseconds are reported.
+
+RETURNS:
+    + TRUE if the event loop is ready.
+    + FALSE if any of the descriptors could not be created.
+*/
+char initializeEventLoop(unsigned int tick_ms, unsigned int timeout_ms)
+{
+    struct itimerspec period;
+    struct epoll_event ev;
+
+    switch_timeout = (int64_t)timeout_ms * EVENT_NANOS_PER_MILLI;
+
+    /*
+    NOTE:
+        - SIGCHLD has to be blocked for the signalfd to receive it. Children
+        get an empty mask back before they exec.
+    */
+    sigemptyset(&signal_mask);
+    sigemptyset(&caught);
+    sigaddset(&signal_mask, SIGCHLD);
+    if (sigprocmask(SIG_BLOCK, &signal_mask, NULL) < 0 ||
+        (signal_fd = signalfd(-1, &signal_mask,
+                              SFD_NONBLOCK | SFD_CLOEXEC)) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not create SIGCHLD descriptor\n");
+        return FALSE;
+    }
+
+    if ((timer_fd = timerfd_create(CLOCK_MONOTONIC,
+                                   TFD_NONBLOCK | TFD_CLOEXEC)) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not create tick timer\n");
+        return FALSE;
+    }
+    period.it_interval.tv_sec = tick_ms / 1000;
+    period.it_interval.tv_nsec = (tick_ms % 1000) * EVENT_NANOS_PER_MILLI;
+    period.it_value = period.it_interval;
+    if (timerfd_settime(timer_fd, 0, &period, NULL) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not arm tick timer\n");
+        return FALSE;
+    }
+    tick_period = (int64_t)tick_ms * EVENT_NANOS_PER_MILLI;
+    next_tick = monotonicNanos() + tick_period;
+
+    /*
+    NOTE:
+        - A one-shot timer, armed at the exact instant of a job arrival that
+        should not have to wait for the next tick.
+    */
+    if ((arrival_fd = timerfd_create(CLOCK_MONOTONIC,
+                                     TFD_NONBLOCK | TFD_CLOEXEC)) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not create arrival timer\n");
+        return FALSE;
+    }
+
+    if ((epoll_fd = epoll_create1(EPOLL_CLOEXEC)) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not create event loop\n");
+        return FALSE;
+    }
+    ev.events = EPOLLIN;
+    ev.data.fd = signal_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, signal_fd, &ev);
+    ev.data.fd = timer_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev);
+    ev.data.fd = arrival_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, arrival_fd, &ev);
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Has signal `sig` delivered through the event loop instead of acting on
+    it. Whether it arrived is then asked with `takeSignal()`.
+
+RETURNS:
+    + TRUE if the signal is caught.
+    + FALSE otherwise.
+*/
+char catchSignal(int sig)
+{
+    sigaddset(&signal_mask, sig);
+    if (sigprocmask(SIG_BLOCK, &signal_mask, NULL) < 0 ||
+        signalfd(signal_fd, &signal_mask, SFD_NONBLOCK | SFD_CLOEXEC) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not catch signal %d\n", sig);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Checks whether caught signal `sig` arrived since it was last taken.
+
+RETURNS:
+    + TRUE if it arrived.
+    + FALSE otherwise.
+*/
+char takeSignal(int sig)
+{
+    if (!sigismember(&caught, sig))
+        return FALSE;
+
+    sigdelset(&caught, sig);
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Adds descriptor `fd` to the event loop. `handler` is called with it
+    whenever it is ready to read.
+
+RETURNS:
+    + TRUE if the descriptor is watched.
+    + FALSE if there is no room for it or epoll refused it.
+*/
+char watchDescriptor(int fd, void (*handler)(int))
+{
+    struct epoll_event ev;
+
+    if (watched_count == EVENT_MAX_WATCHED)
+    {
+        fprintf(stderr, "ERROR: Too many descriptors to watch\n");
+        return FALSE;
+    }
+
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not watch descriptor %d\n", fd);
+        return FALSE;
+    }
+
+    watched_fds[watched_count] = fd;
+    watched_handlers[watched_count] = handler;
+    watched_count++;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Takes descriptor `fd` out of the event loop. The caller still owns it
+    and closes it.
+
+RETURNS:
+    + Nothing.
+*/
+void unwatchDescriptor(int fd)
+{
+    int i;
+
+    for (i = 0; i < watched_count; i++)
+    {
+        if (watched_fds[i] != fd)
+            continue;
+
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+        watched_count--;
+        watched_fds[i] = watched_fds[watched_count];
+        watched_handlers[i] = watched_handlers[watched_count];
+        return;
+    }
+}
+
+/*
+DESCRIPTION:
+    - Sets how many timed-out confirmations a job is allowed before it is
+    quarantined. EVENT_NO_QUARANTINE never quarantines.
+
+RETURNS:
+    + Nothing.
+*/
+void configureWatchdog(int timeouts)
+{
+    quarantine_after = timeouts;
+}
+
+/*
+DESCRIPTION:
+    - Starts supervising the child process `pid` that runs block `p`.
+
+RETURNS:
+    + Nothing.
+*/
+void watchChild(pid_t pid, Block *p)
+{
+    int i;
+
+    if (2 * (child_count + 1) > child_capacity && !growChildren())
+    {
+        fprintf(stderr, "ERROR: Could not supervise process %d\n", (int)pid);
+        return;
+    }
+
+    for (i = hashPid(pid); children[i].pid; i = (i + 1) & (child_capacity - 1))
+        ;
+
+    children[i].pid = pid;
+    children[i].block = p;
+    children[i].pending = EVENT_PENDING_NONE;
+    children[i].escalation = 0;
+    children[i].expires = 0;
+    children[i].stopped = FALSE;
+    child_count++;
+}
+
+/*
+DESCRIPTION:
+    - Notes that a signal was sent to `pid` and that a stop, continue or exit
+    confirmation (`pending`) should arrive within the switch timeout.
+
+RETURNS:
+    + Nothing.
+*/
+void expectChild(pid_t pid, int pending)
+{
+    Child *c = findChild(pid);
+
+    if (c)
+    {
+        setPending(c, pending);
+        c->escalation = 0;
+        c->expires = monotonicNanos() + switch_timeout;
+    }
+}
+
+/*
+DESCRIPTION:
+    - Attaches block `p` to a child that was launched without one, such as a
+    pre-forked worker that is handed its first job.
+
+RETURNS:
+    + Nothing.
+*/
+void adoptChild(pid_t pid, Block *p)
+{
+    Child *c = findChild(pid);
+
+    if (c)
+        c->block = p;
+}
+
+/*
+DESCRIPTION:
+    - Detaches the block from a child that is being terminated. The block may
+    be freed straight away, and the exit is reaped silently later on.
+
+RETURNS:
+    + Nothing.
+*/
+void releaseChild(pid_t pid)
+{
+    Child *c = findChild(pid);
+
+    if (c)
+        c->block = NULL;
+}
+
+/*
+DESCRIPTION:
+    - Checks whether `pid` is still a live, supervised child.
+
+RETURNS:
+    + TRUE if the child has not been reaped.
+    + FALSE otherwise.
+*/
+char isChildAlive(pid_t pid)
+{
+    return findChild(pid) != NULL;
+}
+
+/*
+DESCRIPTION:
+    - Checks whether the child `pid` has confirmed that it is stopped.
+
+RETURNS:
+    + TRUE if the last state change reaped for it was a stop.
+    + FALSE if it is running, unconfirmed or no longer supervised.
+*/
+char isChildStopped(pid_t pid)
+{
+    Child *c = findChild(pid);
+
+    return c && c->stopped;
+}
+
+/*
+DESCRIPTION:
+    - Takes one block whose process exited without being asked to.
+
+RETURNS:
+    + Block* of the lost job.
+    + NULL if there are none left.
+*/
+Block *collectLostChild()
+{
+    if (!lost_count)
+        return NULL;
+
+    return lost[--lost_count];
+}
+
+/*
+DESCRIPTION:
+    - Reaps every child state change that is ready and matches it against
+    what the dispatcher expected.
+
+    - A child that stopped while its block should be running had its SIGCONT
+    overtake the stop it was still acting on. It is continued again.
+
+    - A child that exited while its block is still queued died on its own.
+    Its block is marked terminated and reported as lost.
+
+    - Any other signal read along the way was asked for with `catchSignal()`
+    and is noted for `takeSignal()`.
+
+RETURNS:
+    + Nothing.
+*/
+static void reapChildren()
+{
+    struct signalfd_siginfo info;
+    int status;
+    pid_t pid;
+    Child *c;
+
+    while (read(signal_fd, &info, sizeof(info)) == sizeof(info))
+    {
+        if (info.ssi_signo != SIGCHLD)
+            sigaddset(&caught, info.ssi_signo);
+    }
+
+    while ((pid = waitpid(-1, &status,
+                          WNOHANG | WUNTRACED | WCONTINUED)) > 0)
+    {
+        if (!(c = findChild(pid)))
+            continue;
+
+        if (WIFSTOPPED(status))
+        {
+            c->stopped = TRUE;
+            if (c->pending == EVENT_PENDING_STOP)
+                setPending(c, EVENT_PENDING_NONE);
+
+            if (c->block && c->block->status == PCB_RUNNING &&
+                c->pending != EVENT_PENDING_EXIT)
+            {
+                kill(pid, SIGCONT);
+                expectChild(pid, EVENT_PENDING_CONT);
+            }
+        }
+        else if (WIFCONTINUED(status))
+        {
+            c->stopped = FALSE;
+            if (c->pending == EVENT_PENDING_CONT)
+                setPending(c, EVENT_PENDING_NONE);
+        }
+        else
+        {
+            if (c->block && c->pending != EVENT_PENDING_EXIT)
+            {
+                fprintf(stderr, "ALERT: Process %d exited unexpectedly\n",
+                        (int)pid);
+                c->block->status = PCB_TERMINATED;
+                reportLost(c->block);
+            }
+            forgetChild(c);
+        }
+    }
+}
+
+/*
+DESCRIPTION:
+    - Finds the next signal to send a child whose `pending` confirmation is
+    overdue after `escalation` earlier steps. A stop goes from SIGTSTP to
+    SIGSTOP, and an exit from SIGINT to SIGTERM to SIGKILL.
+
+RETURNS:
+    + The signal to send.
+    + Zero if there is nothing left to escalate to.
+*/
+static int escalationSignal(int pending, int escalation)
+{
+    if (pending == EVENT_PENDING_STOP && escalation == 0)
+        return SIGSTOP;
+    if (pending == EVENT_PENDING_EXIT && escalation < 2)
+        return escalation ? SIGKILL : SIGTERM;
+
+    return 0;
+}
+
+/*
+DESCRIPTION:
+    - Kills the child `c`, whose job has timed out too often, and hands its
+    job back to the dispatcher as lost.
+
+RETURNS:
+    + Nothing.
+*/
+static void quarantineChild(Child *c)
+{
+    fprintf(stderr, "ALERT: Quarantining process %d after %d timeouts\n",
+            (int)c->pid, blockInfo(c->block)->timeouts);
+
+    c->block->status = PCB_TERMINATED;
+    reportLost(c->block);
+    c->block = NULL;
+    quarantine_count++;
+
+    kill(c->pid, SIGKILL);
+    setPending(c, EVENT_PENDING_EXIT);
+    c->escalation = 0;
+    c->expires = monotonicNanos() + switch_timeout;
+}
+
+/*
+DESCRIPTION:
+    - Handles context switches whose confirmation is overdue. The signal is
+    escalated to the next one that cannot be ignored and the timeout starts
+    over. Once there is nothing left to escalate to, the pending state is
+    cleared so the timeout is not reported again. Every timeout counts
+    against the child's job, which may end up quarantined.
+
+RETURNS:
+    + Nothing.
+*/
+static void checkTimeouts()
+{
+    static const char *names[] = {"none", "stop", "continue", "exit"};
+    int64_t now = monotonicNanos();
+    Child *c;
+    int i, sig;
+
+    for (i = 0; pending_count && i < child_capacity; i++)
+    {
+        c = &children[i];
+        if (!c->pid || c->pending == EVENT_PENDING_NONE || now < c->expires)
+            continue;
+
+        timeout_count++;
+        if (c->block)
+            blockInfo(c->block)->timeouts++;
+
+        if (c->block && quarantine_after != EVENT_NO_QUARANTINE &&
+            blockInfo(c->block)->timeouts >= quarantine_after)
+        {
+            quarantineChild(c);
+            continue;
+        }
+
+        if (!(sig = escalationSignal(c->pending, c->escalation)))
+        {
+            fprintf(stderr, "WARNING: Process %d did not confirm %s in time\n",
+                    (int)c->pid, names[c->pending]);
+            setPending(c, EVENT_PENDING_NONE);
+            continue;
+        }
+
+        fprintf(stderr, "WARNING: Process %d did not confirm %s in time, "
+                        "sending %s\n",
+                (int)c->pid, names[c->pending],
+                sig == SIGSTOP ? "SIGSTOP"
+                               : (sig == SIGTERM ? "SIGTERM" : "SIGKILL"));
+        kill(c->pid, sig);
+        c->escalation++;
+        c->expires = now + switch_timeout;
+        escalation_count++;
+    }
+}
+
+/*
+DESCRIPTION:
+    - Records how late the wake-up for the latest of `expirations` timer ex-
+    pirations came.
+
+RETURNS:
+    + Nothing.
+*/
+static void recordJitter(uint64_t expirations)
+{
+    int64_t late;
+
+    next_tick += (int64_t)(expirations - 1) * tick_period;
+    late = monotonicNanos() - next_tick;
+    next_tick += tick_period;
+    if (late < 0)
+        late = 0;
+
+    jitter_last = late;
+    jitter_total += (double)late;
+    jitter_squares += (double)late * (double)late;
+    if (late > jitter_max)
+        jitter_max = late;
+    jitter_count++;
+}
+
+/*
+DESCRIPTION:
+    - Tells when the tick timer is next due to expire.
+
+RETURNS:
+    + The expiry time on the monotonic clock, in nanoseconds.
+*/
+int64_t nextTickNanos()
+{
+    return next_tick;
+}
+
+/*
+DESCRIPTION:
+    - Reads the tick jitter so far, in microseconds: how late the last tick
+    was, the average and the maximum.
+
+RETURNS:
+    + The number of ticks seen so far.
+*/
+uint64_t sampleTickJitter(double *last_us, double *mean_us, double *max_us)
+{
+    *last_us = (double)jitter_last / 1000.0;
+    *mean_us = jitter_count ? jitter_total / (double)jitter_count / 1000.0
+                            : 0.0;
+    *max_us = (double)jitter_max / 1000.0;
+
+    return jitter_count;
+}
+
+/*
+DESCRIPTION:
+    - Prints the average, standard deviation and maximum tick jitter in micro-
+    seconds. Prints nothing if the timer never ticked.
+
+RETURNS:
+    + Nothing.
+*/
+void printTickJitter()
+{
+    double mean, variance;
+
+    if (!jitter_count)
+        return;
+
+    mean = jitter_total / (double)jitter_count;
+    variance = jitter_squares / (double)jitter_count - mean * mean;
+    printf("Tick jitter avg/stddev/max: %.1f/%.1f/%.1f us over %" PRIu64
+           " ticks\n",
+           mean / 1000.0, sqrt(variance > 0.0 ? variance : 0.0) / 1000.0,
+           (double)jitter_max / 1000.0, jitter_count);
+}
+
+/*
+DESCRIPTION:
+    - Prints how many confirmations timed out, how many signals were escala-
+    ted and how many jobs were quarantined. Prints nothing if no confirmation
+    ever timed out.
+
+RETURNS:
+    + Nothing.
+*/
+void printWatchdogStats()
+{
+    if (!timeout_count)
+        return;
+
+    printf("Watchdog timeouts/escalations/quarantined: %" PRIu64 "/%" PRIu64
+           "/%" PRIu64 "\n",
+           timeout_count, escalation_count, quarantine_count);
+}
+
+/*
+DESCRIPTION:
+    - Waits up to `timeout_ms` milliseconds (-1 for no limit) for events and
+    handles whatever is ready. Ticks of the timer are consumed here.
+
+RETURNS:
+    + TRUE if the timer ticked.
+    + FALSE otherwise.
+*/
+static char pollEvents(int timeout_ms)
+{
+    struct epoll_event events[EVENT_MAX_EVENTS];
+    uint64_t expirations;
+    char ticked = FALSE;
+    int n, i, j;
+
+    if ((n = epoll_wait(epoll_fd, events, EVENT_MAX_EVENTS, timeout_ms)) < 0)
+    {
+        if (errno == EINTR)
+            return FALSE;
+        fprintf(stderr, "FATAL: Event loop failed\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (i = 0; i < n; i++)
+    {
+        if (events[i].data.fd == signal_fd)
+        {
+            reapChildren();
+        }
+        else if (events[i].data.fd == timer_fd)
+        {
+            if (read(timer_fd, &expirations, sizeof(expirations)) > 0)
+            {
+                recordJitter(expirations);
+                ticked = TRUE;
+            }
+        }
+        else if (events[i].data.fd == arrival_fd)
+        {
+            if (read(arrival_fd, &expirations, sizeof(expirations)) > 0)
+                arrival_due = TRUE;
+        }
+        else
+        {
+            for (j = 0; j < watched_count; j++)
+            {
+                if (events[i].data.fd == watched_fds[j])
+                {
+                    watched_handlers[j](watched_fds[j]);
+                    break;
+                }
+            }
+        }
+    }
+
+    checkTimeouts();
+
+    return ticked;
+}
+
+/*
+DESCRIPTION:
+    - Blocks until the next tick of the timer. Child events that arrive in
+    the meantime are handled as they come in.
+
+RETURNS:
+    + Nothing.
+*/
+void awaitTick()
+{
+    while (!pollEvents(-1))
+        ;
+}
+
+/*
+DESCRIPTION:
+    - Arms the arrival timer to go off once at `at` on the monotonic clock.
+    An instant that has already passed goes off straight away, and zero dis-
+    arms the timer.
+
+RETURNS:
+    + Nothing.
+*/
+void armArrival(int64_t at)
+{
+    struct itimerspec when;
+
+    memset(&when, 0, sizeof(when));
+    when.it_value.tv_sec = at / EVENT_NANOS_PER_SECOND;
+    when.it_value.tv_nsec = at % EVENT_NANOS_PER_SECOND;
+    arrival_armed = at != 0;
+    arrival_due = FALSE;
+
+    if (timerfd_settime(arrival_fd, TFD_TIMER_ABSTIME, &when, NULL) < 0)
+        fprintf(stderr, "WARNING: Could not arm arrival timer\n");
+}
+
+/*
+DESCRIPTION:
+    - Blocks until the next tick of the timer or until the arrival timer goes
+    off, whichever is first. A tick wins if both are ready, and the arrival
+    timer is disarmed after it.
+
+RETURNS:
+    + TRUE if the timer ticked.
+    + FALSE if the wait was cut short by the arrival timer.
+*/
+char awaitSlice()
+{
+    while (!pollEvents(-1))
+    {
+        if (arrival_due)
+        {
+            arrival_armed = arrival_due = FALSE;
+            return FALSE;
+        }
+    }
+
+    if (arrival_armed)
+        armArrival(0);
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Waits until every outstanding stop, continue or exit confirmation has
+    arrived or timed out. Ticks that pass in the meantime are dropped.
+
+RETURNS:
+    + Nothing.
+*/
+void awaitPending()
+{
+    while (pending_count)
+        pollEvents(-1);
+}
+
+/*
+DESCRIPTION:
+    - Sends `sig` to each of the `n` children in `pids` in one pass and notes
+    the confirmation (`pending`) expected from each. The confirmations are
+    collected together by the event loop rather than one `waitpid()` each.
+
+RETURNS:
+    + Nothing.
+*/
+void signalChildren(pid_t *pids, int n, int sig, int pending)
+{
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        kill(pids[i], sig);
+        expectChild(pids[i], pending);
+    }
+}
+
+/*
+DESCRIPTION:
+    - Waits for every supervised child to be reaped, or for the switch time-
+    out to pass, whichever comes first. Used at shutdown so that no child is
+    left printing after the dispatcher has reported its metrics. An exit
+    that is still being escalated is waited for to the end, so that a child
+    ignoring SIGINT is not left behind.
+
+RETURNS:
+    + Nothing.
+*/
+void awaitChildren()
+{
+    int64_t expires = monotonicNanos() + switch_timeout;
+    int64_t left;
+
+    while (child_count &&
+           ((left = expires - monotonicNanos()) > 0 || pending_count))
+    {
+        if (left <= 0)
+            left = switch_timeout;
+        pollEvents((int)(left / EVENT_NANOS_PER_MILLI) + 1);
+    }
+}
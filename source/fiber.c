@@ -0,0 +1,233 @@
+#include <fiber.h>
+#include <event.h>
+
+/*
+NOTE:
+    - Context of the dispatcher while a fiber runs, and the fiber running.
+    Fibers only ever switch back to the dispatcher, never to each other.
+*/
+static ucontext_t dispatcher_context;
+static Fiber *running = NULL;
+static int kernel = FIBER_KERNEL_INT;
+static char guarded = FALSE;
+static size_t guard_size = 0;
+
+static uint64_t fiber_count = 0;
+static uint64_t switch_count = 0;
+static int64_t switch_total = 0;
+static uint64_t total_iterations = 0;
+
+/*
+DESCRIPTION:
+    - Reads the CPU time of the calling thread.
+
+RETURNS:
+    + The CPU time in nanoseconds.
+*/
+static uint64_t threadNanos()
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+    return (uint64_t)now.tv_sec * EVENT_NANOS_PER_SECOND + now.tv_nsec;
+}
+
+/*
+DESCRIPTION:
+    - Body of every fiber. Runs one chunk of the kernel at a time and yields
+    once its slice is over. It never returns, a finished job's fiber is just
+    destroyed.
+
+RETURNS:
+    + Nothing.
+*/
+static void fiberMain()
+{
+    Fiber *f;
+    int i;
+
+    while (TRUE)
+    {
+        f = running;
+        if (kernel == FIBER_KERNEL_FLOAT)
+        {
+            for (i = 0; i < FIBER_CHUNK; i++)
+                f->value = f->value * 0.999999 + sqrt(f->value + i);
+        }
+        else
+        {
+            for (i = 0; i < FIBER_CHUNK; i++)
+            {
+                f->state ^= f->state << 13;
+                f->state ^= f->state >> 7;
+                f->state ^= f->state << 17;
+            }
+        }
+        f->iterations += FIBER_CHUNK;
+
+        if (monotonicNanos() >= f->until)
+            swapcontext(&f->context, &dispatcher_context);
+    }
+}
+
+/*
+DESCRIPTION:
+    - Selects the kernel fibers burn CPU with, one of the `FIBER_KERNEL_*`
+    macros, and whether their stacks get a guard page.
+
+RETURNS:
+    + Nothing.
+*/
+void configureFibers(int selected, char guard)
+{
+    kernel = selected;
+    guarded = guard;
+}
+
+/*
+DESCRIPTION:
+    - Sets up the context of fiber `f` to start the kernel on the stack above
+    its guard. `getcontext()` returns twice, so this is kept apart from where
+    `f` is allocated.
+
+RETURNS:
+    + Nothing.
+*/
+static void prepareContext(Fiber *f)
+{
+    getcontext(&f->context);
+    f->context.uc_stack.ss_sp = (char *)f->stack + guard_size;
+    f->context.uc_stack.ss_size = FIBER_STACK_SIZE;
+    f->context.uc_link = NULL;
+    makecontext(&f->context, fiberMain, 0);
+}
+
+/*
+DESCRIPTION:
+    - Creates a fiber with its own stack, ready to run from the start of the
+    kernel. Stacks are reserved but only backed by memory once touched, so a
+    fiber costs a page or two of memory. With guard pages on, the lowest
+    page of each stack is a guard page, so a fiber that overflows its stack
+    faults instead of writing over the next one. It also splits the stack
+    into a mapping of its own, so the guard is opt-in.
+
+RETURNS:
+    + Fiber* of the new fiber.
+    + NULL if failed at allocating memory.
+*/
+Fiber *createFiber()
+{
+    Fiber *f;
+
+    if (!(f = (Fiber *)malloc(sizeof(Fiber))))
+    {
+        fprintf(stderr, "ERROR: Could not create fiber\n");
+        return NULL;
+    }
+
+    if (guarded && !guard_size)
+        guard_size = (size_t)sysconf(_SC_PAGESIZE);
+    if ((f->stack = mmap(NULL, guard_size + FIBER_STACK_SIZE,
+                         PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE |
+                             MAP_STACK,
+                         -1, 0)) == MAP_FAILED)
+    {
+        fprintf(stderr, "ERROR: Could not create fiber stack\n");
+        free(f);
+        return NULL;
+    }
+    if (guard_size && mprotect(f->stack, guard_size, PROT_NONE) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not guard fiber stack\n");
+        munmap(f->stack, guard_size + FIBER_STACK_SIZE);
+        free(f);
+        return NULL;
+    }
+
+    prepareContext(f);
+
+    f->until = 0;
+    f->iterations = 0;
+    f->cpu_ns = 0;
+    f->state = (uint64_t)(uintptr_t)f | 1;
+    f->value = 1.0;
+    fiber_count++;
+
+    return f;
+}
+
+/*
+DESCRIPTION:
+    - Runs fiber `f` until the monotonic clock reaches `until`. The fiber is
+    preempted at the first chunk boundary after that.
+
+RETURNS:
+    + Nothing.
+*/
+void runFiber(Fiber *f, int64_t until)
+{
+    int64_t started = monotonicNanos();
+    uint64_t cpu = threadNanos();
+    uint64_t before = f->iterations;
+
+    f->until = until;
+    running = f;
+    swapcontext(&dispatcher_context, &f->context);
+    running = NULL;
+
+    f->cpu_ns += threadNanos() - cpu;
+    total_iterations += f->iterations - before;
+
+    /*
+    NOTE:
+        - The switch cost is the time the round trip took beyond the slice
+        itself, which is everything past `until`.
+    */
+    if (until > started)
+    {
+        switch_total += monotonicNanos() - until;
+        switch_count++;
+    }
+}
+
+/*
+DESCRIPTION:
+    - Frees fiber `f` and its stack. It must not be running.
+
+RETURNS:
+    + Nothing.
+*/
+void destroyFiber(Fiber *f)
+{
+    if (!f)
+        return;
+
+    munmap(f->stack, guard_size + FIBER_STACK_SIZE);
+    free(f);
+}
+
+/*
+DESCRIPTION:
+    - Prints how many fibers were created, the kernel iterations they ran and
+    how far past the end of its slice a fiber yields on average. Prints
+    nothing if no fiber was created.
+
+RETURNS:
+    + Nothing.
+*/
+void printFiberStats()
+{
+    if (!fiber_count)
+        return;
+
+    printf("Fibers: %" PRIu64 " created, %" PRIu64 " kernel iterations\n",
+           fiber_count, total_iterations);
+    if (switch_count)
+    {
+        printf("Fiber preemption overshoot avg: %.1f us over %" PRIu64
+               " slices\n",
+               (double)switch_total / switch_count / 1000.0, switch_count);
+    }
+}
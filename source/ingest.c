@@ -0,0 +1,500 @@
+#include <ingest.h>
+
+/*
+NOTE:
+    - The ingest queue is an intrusive multi-producer single-consumer list.
+    `head` is where producers link new nodes in and `tail` is where the dis-
+    patcher takes them out. A stub node keeps the list from ever being empty,
+    so a producer never has to touch `tail`. A producer that has swapped
+    `head` but not yet linked its node in hides the nodes behind it for a
+    moment. They are then simply picked up on the next drain.
+*/
+static IngestNode stub = {NULL};
+static IngestNode *head = &stub;
+static IngestNode *tail = &stub;
+
+static uint64_t submitted = 0;
+static uint64_t taken = 0;
+static uint64_t rejected = 0;
+
+/*
+NOTE:
+    - Where submitted jobs are read from. All of them are watched by the
+    dispatcher's own event loop, so they are producers on its thread. Other
+    threads can submit directly.
+*/
+static IngestSource sources[INGEST_MAX_SOURCES];
+static int source_count = 0;
+static int fifo_writer = -1;
+static char *socket_path = NULL;
+static char ingest_open = FALSE;
+
+static int64_t tick_ns = 0;
+static const char *default_workload = NULL;
+
+/*
+DESCRIPTION:
+    - Sets the tick length and default workload that submitted lines are
+    read with.
+
+RETURNS:
+    + Nothing.
+*/
+void configureIngest(int64_t tick, const char *workload)
+{
+    tick_ns = tick;
+    default_workload = workload;
+}
+
+/*
+DESCRIPTION:
+    - Links node `n` in at the head of the ingest queue. Safe to call from
+    any number of threads at once.
+
+RETURNS:
+    + Nothing.
+*/
+static void pushNode(IngestNode *n)
+{
+    IngestNode *prev;
+
+    __atomic_store_n(&n->next, NULL, __ATOMIC_RELAXED);
+    prev = __atomic_exchange_n(&head, n, __ATOMIC_ACQ_REL);
+    __atomic_store_n(&prev->next, n, __ATOMIC_RELEASE);
+}
+
+/*
+DESCRIPTION:
+    - Takes the oldest node off the tail of the ingest queue. Only the dis-
+    patcher calls this.
+
+RETURNS:
+    + IngestNode* of the oldest job.
+    + NULL if there is none, or none that is fully linked in yet.
+*/
+static IngestNode *popNode()
+{
+    IngestNode *t = tail;
+    IngestNode *next = __atomic_load_n(&t->next, __ATOMIC_ACQUIRE);
+
+    if (t == &stub)
+    {
+        if (!next)
+            return NULL;
+        tail = t = next;
+        next = __atomic_load_n(&t->next, __ATOMIC_ACQUIRE);
+    }
+    if (next)
+    {
+        tail = next;
+        return t;
+    }
+    if (t != __atomic_load_n(&head, __ATOMIC_ACQUIRE))
+        return NULL;
+
+    /*
+    NOTE:
+        - `t` is the last node. Putting the stub back behind it lets `t` be
+        taken without leaving the list empty.
+    */
+    pushNode(&stub);
+    if ((next = __atomic_load_n(&t->next, __ATOMIC_ACQUIRE)))
+    {
+        tail = next;
+        return t;
+    }
+
+    return NULL;
+}
+
+/*
+DESCRIPTION:
+    - Submits job `r` to the dispatcher. It is taken in at the next tick. Safe
+    to call from any thread, and never blocks.
+
+RETURNS:
+    + TRUE if the job was submitted.
+    + FALSE if failed at allocating memory.
+*/
+char submitIngest(JobRow *r)
+{
+    IngestNode *n;
+
+    if (!(n = (IngestNode *)malloc(sizeof(IngestNode))))
+    {
+        fprintf(stderr, "ERROR: Could not submit job\n");
+        return FALSE;
+    }
+
+    n->row = *r;
+    __atomic_fetch_add(&submitted, 1, __ATOMIC_RELAXED);
+    pushNode(n);
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Moves every submitted job into table `t` at tick `timer`. A job that
+    arrives `now`, or at a time that has already passed, arrives at `timer`.
+
+RETURNS:
+    + The number of jobs taken in.
+*/
+int drainIngest(JobTable *t, uint64_t timer)
+{
+    IngestNode *n;
+    int count = 0;
+
+    while ((n = popNode()))
+    {
+        if (n->row.arrival == JOBS_ARRIVE_NOW ||
+            (uint64_t)n->row.arrival < timer)
+        {
+            n->row.arrival = (int)timer;
+            n->row.offset_ns = 0;
+        }
+        if (insertJob(t, &n->row))
+            count++;
+        free(n);
+    }
+    taken += count;
+
+    return count;
+}
+
+/*
+DESCRIPTION:
+    - Finds the source reading from descriptor `fd`.
+
+RETURNS:
+    + IngestSource* of the source.
+    + NULL if there is none.
+*/
+static IngestSource *findSource(int fd)
+{
+    int i;
+
+    for (i = 0; i < source_count; i++)
+    {
+        if (sources[i].fd == fd)
+            return &sources[i];
+    }
+
+    return NULL;
+}
+
+/*
+DESCRIPTION:
+    - Stops reading from source `s` and closes it.
+
+RETURNS:
+    + Nothing.
+*/
+static void dropSource(IngestSource *s)
+{
+    unwatchDescriptor(s->fd);
+    close(s->fd);
+    *s = sources[--source_count];
+}
+
+/*
+DESCRIPTION:
+    - Submits the job on one line read from a source. Lines that are not a
+    job are warned about and counted.
+
+RETURNS:
+    + Nothing.
+*/
+static void submitLine(char *line)
+{
+    const char *reason;
+    JobRow row;
+
+    if (line[strspn(line, " \t\r")] == '\0')
+        return;
+
+    if ((reason = parseJob(line, &row, tick_ns, default_workload)))
+    {
+        fprintf(stderr, "WARNING: Rejected submitted job (%s): %s\n", reason,
+                line);
+        rejected++;
+        return;
+    }
+
+    submitIngest(&row);
+}
+
+/*
+DESCRIPTION:
+    - Rejects the line source `s` is part of the way through, as it is too
+    long to be a job.
+
+RETURNS:
+    + Nothing.
+*/
+static void rejectLongLine(IngestSource *s)
+{
+    fprintf(stderr, "WARNING: Submitted line is too long\n");
+    rejected++;
+    s->pending_length = 0;
+}
+
+/*
+DESCRIPTION:
+    - Reads whatever is ready on source descriptor `fd` and submits every
+    complete line. The rest of a line is kept for the next read. A line too
+    long to be a job is rejected once, and thrown away up to its newline. A
+    socket connection that is closed is dropped. The FIFO never reads as
+    closed.
+
+RETURNS:
+    + Nothing.
+*/
+static void readSource(int fd)
+{
+    IngestSource *s = findSource(fd);
+    char buffer[INGEST_READ_SIZE];
+    char *line, *end;
+    size_t length;
+    ssize_t n;
+
+    if (!s)
+        return;
+
+    while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (line = buffer; (end = memchr(line, '\n', buffer + n - line));
+             line = end + 1)
+        {
+            *end = '\0';
+            length = (size_t)(end - line);
+            if (s->overlong)
+            {
+                s->overlong = FALSE;
+            }
+            else if (s->pending_length + length >= sizeof(s->pending))
+            {
+                rejectLongLine(s);
+            }
+            else if (s->pending_length)
+            {
+                memcpy(s->pending + s->pending_length, line, length + 1);
+                s->pending_length = 0;
+                submitLine(s->pending);
+            }
+            else
+            {
+                submitLine(line);
+            }
+        }
+
+        length = (size_t)(buffer + n - line);
+        if (!length || s->overlong)
+            continue;
+        if (s->pending_length + length >= sizeof(s->pending))
+        {
+            rejectLongLine(s);
+            s->overlong = TRUE;
+        }
+        else
+        {
+            memcpy(s->pending + s->pending_length, line, length);
+            s->pending_length += length;
+            s->pending[s->pending_length] = '\0';
+        }
+    }
+
+    if (n == 0)
+        dropSource(s);
+}
+
+/*
+DESCRIPTION:
+    - Accepts every connection waiting on listening socket `fd` and reads
+    jobs from each.
+
+RETURNS:
+    + Nothing.
+*/
+static void acceptSources(int fd)
+{
+    int client;
+
+    while ((client = accept4(fd, NULL, NULL,
+                             SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+    {
+        if (source_count == INGEST_MAX_SOURCES ||
+            !watchDescriptor(client, readSource))
+        {
+            fprintf(stderr, "WARNING: Too many job submitters\n");
+            close(client);
+            continue;
+        }
+
+        memset(&sources[source_count], 0, sizeof(IngestSource));
+        sources[source_count++].fd = client;
+    }
+}
+
+/*
+DESCRIPTION:
+    - Adds descriptor `fd` as a source, read by `handler` when ready.
+
+RETURNS:
+    + TRUE if the source is watched.
+    + FALSE otherwise, after closing `fd`.
+*/
+static char addSource(int fd, void (*handler)(int))
+{
+    if (source_count == INGEST_MAX_SOURCES || !watchDescriptor(fd, handler))
+    {
+        close(fd);
+        return FALSE;
+    }
+
+    memset(&sources[source_count], 0, sizeof(IngestSource));
+    sources[source_count].fd = fd;
+    source_count++;
+    ingest_open = TRUE;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Creates a FIFO at `path`, unless there is one already, and reads jobs
+    written to it. The dispatcher holds a write end of its own so that the
+    FIFO never reads as closed between writers.
+
+RETURNS:
+    + TRUE if the FIFO is open.
+    + FALSE otherwise.
+*/
+char openIngestFifo(const char *path)
+{
+    int fd;
+
+    if ((mkfifo(path, 0600) < 0 && errno != EEXIST) ||
+        (fd = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC)) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not open FIFO \"%s\": %s\n", path,
+                strerror(errno));
+        return FALSE;
+    }
+    if ((fifo_writer = open(path, O_WRONLY | O_NONBLOCK | O_CLOEXEC)) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not hold FIFO \"%s\" open\n", path);
+        close(fd);
+        return FALSE;
+    }
+
+    return addSource(fd, readSource);
+}
+
+/*
+DESCRIPTION:
+    - Listens on a Unix socket at `path`, replacing a socket already there.
+    Every client that connects can write jobs to it, one per line.
+
+RETURNS:
+    + TRUE if the socket is listening.
+    + FALSE otherwise, or if something other than a socket is at `path`.
+*/
+char openIngestSocket(const char *path)
+{
+    struct sockaddr_un address;
+    struct stat existing;
+    int fd;
+
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "ERROR: Submission socket path is too long\n");
+        return FALSE;
+    }
+    if (!lstat(path, &existing) && !S_ISSOCK(existing.st_mode))
+    {
+        fprintf(stderr, "ERROR: \"%s\" exists and is not a socket\n", path);
+        return FALSE;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    if ((fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                     0)) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not create submission socket\n");
+        return FALSE;
+    }
+    unlink(path);
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+        listen(fd, INGEST_BACKLOG) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not listen on \"%s\": %s\n", path,
+                strerror(errno));
+        close(fd);
+        return FALSE;
+    }
+
+    if (!addSource(fd, acceptSources))
+        return FALSE;
+    socket_path = strdup(path);
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Tells whether jobs can still be submitted from outside.
+
+RETURNS:
+    + TRUE if a FIFO or socket is still open.
+    + FALSE otherwise.
+*/
+char isIngestOpen()
+{
+    return ingest_open;
+}
+
+/*
+DESCRIPTION:
+    - Stops taking jobs from outside. Lines already read are still submitted
+    and the socket file is removed. The FIFO is left for the next run.
+
+RETURNS:
+    + Nothing.
+*/
+void closeIngest()
+{
+    while (source_count)
+        dropSource(&sources[0]);
+
+    if (fifo_writer >= 0)
+        close(fifo_writer);
+    if (socket_path)
+        unlink(socket_path);
+    free(socket_path);
+    fifo_writer = -1;
+    socket_path = NULL;
+    ingest_open = FALSE;
+}
+
+/*
+DESCRIPTION:
+    - Prints how many jobs were submitted, taken in and rejected. Prints
+    nothing if none were submitted.
+
+RETURNS:
+    + Nothing.
+*/
+void printIngestStats()
+{
+    if (!submitted && !rejected)
+        return;
+
+    printf("Jobs submitted/taken in/rejected: %" PRIu64 "/%" PRIu64
+           "/%" PRIu64 "\n",
+           submitted, taken, rejected);
+}
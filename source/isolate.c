@@ -0,0 +1,152 @@
+#include <isolate.h>
+
+/*
+NOTE:
+    - CPUs the job processes are confined to. Only applied when a job cpuset
+    was given or the dispatcher was pinned, in which case the jobs get every
+    allowed CPU except the dispatcher's.
+*/
+static cpu_set_t job_cpus;
+static char confine_jobs = FALSE;
+
+/*
+DESCRIPTION:
+    - Parses a CPU list such as "1-3,6" into `set`.
+
+RETURNS:
+    + TRUE if the list was valid and named at least one CPU.
+    + FALSE otherwise.
+*/
+static char parseCpuList(char *list, cpu_set_t *set)
+{
+    char *cursor = list, *end;
+    long first, last;
+
+    CPU_ZERO(set);
+    while (*cursor)
+    {
+        first = strtol(cursor, &end, 10);
+        if (end == cursor || first < 0)
+            return FALSE;
+        last = first;
+        if (*end == '-')
+        {
+            cursor = end + 1;
+            last = strtol(cursor, &end, 10);
+            if (end == cursor || last < first)
+                return FALSE;
+        }
+        if (last >= CPU_SETSIZE)
+            return FALSE;
+        for (; first <= last; first++)
+            CPU_SET(first, set);
+
+        if (*end == ',')
+            end++;
+        else if (*end)
+            return FALSE;
+        cursor = end;
+    }
+
+    return CPU_COUNT(set) > 0;
+}
+
+/*
+DESCRIPTION:
+    - Applies the isolation settings to the dispatcher. `dispatcher_cpu` pins
+    the dispatcher to one CPU (`ISOLATE_NO_CPU` leaves it unpinned) and `list`
+    is the CPU list for job processes (NULL for the default). `lock_memory`
+    locks the dispatcher's pages in RAM and `realtime` moves it to SCHED_FIFO.
+    The scheduling class is reset on fork, so the jobs never inherit it.
+
+    - Locking memory and raising the scheduling class need privileges, so if
+    they fail a warning is printed and the run goes on without them.
+
+RETURNS:
+    + TRUE if the CPU settings could be applied.
+    + FALSE if a CPU list or CPU number was invalid or not allowed.
+*/
+char configureIsolation(int dispatcher_cpu, char *list, char lock_memory,
+                        char realtime)
+{
+    struct sched_param param;
+    cpu_set_t allowed, pinned;
+
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) < 0)
+        CPU_ZERO(&allowed);
+
+    if (list)
+    {
+        if (!parseCpuList(list, &job_cpus))
+        {
+            fprintf(stderr, "ERROR: Invalid job CPU list \"%s\"\n", list);
+            return FALSE;
+        }
+        confine_jobs = TRUE;
+    }
+
+    if (dispatcher_cpu != ISOLATE_NO_CPU)
+    {
+        CPU_ZERO(&pinned);
+        if (dispatcher_cpu >= 0 && dispatcher_cpu < CPU_SETSIZE)
+            CPU_SET(dispatcher_cpu, &pinned);
+        if (!CPU_COUNT(&pinned) ||
+            sched_setaffinity(0, sizeof(pinned), &pinned) < 0)
+        {
+            fprintf(stderr, "ERROR: Could not pin dispatcher to CPU %d\n",
+                    dispatcher_cpu);
+            return FALSE;
+        }
+
+        /*
+        NOTE:
+            - With no list of their own, jobs keep off the dispatcher's CPU as
+            long as another one is left for them.
+        */
+        if (!list)
+        {
+            CPU_CLR(dispatcher_cpu, &allowed);
+            if (CPU_COUNT(&allowed))
+            {
+                job_cpus = allowed;
+                confine_jobs = TRUE;
+            }
+        }
+    }
+
+    if (lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) < 0)
+    {
+        fprintf(stderr, "WARNING: Could not lock dispatcher memory (%s)\n",
+                strerror(errno));
+    }
+
+    if (realtime)
+    {
+        param.sched_priority = ISOLATE_RT_PRIORITY;
+        if (sched_setscheduler(0, SCHED_FIFO | SCHED_RESET_ON_FORK, &param) < 0)
+        {
+            fprintf(stderr, "WARNING: Could not raise dispatcher to SCHED_FIFO "
+                            "(%s)\n",
+                    strerror(errno));
+        }
+    }
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Confines a newly launched job process to the job CPUs, if there are any.
+
+RETURNS:
+    + Nothing.
+*/
+void isolateChild(pid_t pid)
+{
+    if (confine_jobs && sched_setaffinity(pid, sizeof(job_cpus), &job_cpus) < 0)
+    {
+        fprintf(stderr, "WARNING: Could not confine process %d to the job "
+                        "CPUs\n",
+                (int)pid);
+    }
+}
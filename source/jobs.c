@@ -0,0 +1,705 @@
+#include <jobs.h>
+
+/*
+NOTE:
+    - The table being sorted. `qsort()` passes no context to its comparison
+    function.
+*/
+static JobTable *sorting = NULL;
+
+/*
+NOTE:
+    - Lines of the jobs file that could not be turned into a job, with the
+    reason why. They are listed at the end of the run rather than among the
+    output of the jobs.
+*/
+typedef struct
+{
+    int line;
+    const char *reason;
+    char *text;
+} QuarantinedJob;
+
+static QuarantinedJob *quarantined = NULL;
+static int quarantine_count = 0;
+static int quarantine_capacity = 0;
+
+/*
+DESCRIPTION:
+    - Reads one line of the jobs file into `r`. Ticks are `tick_ns` long, and
+    a job that names no workload gets `workload`. An arrival time of `now`
+    leaves the arrival to whoever takes the job in.
+
+    - The fourth column, an absolute deadline, is optional. So is the fifth,
+    the workload of the job, which needs a deadline column before it (-1 for
+    none). An unknown workload is warned about and replaced.
+
+    - The arrival time may fall part of the way into a tick. The job then
+    belongs to that tick and keeps how far into it it arrives.
+
+RETURNS:
+    + NULL if the line is a job.
+    + Why it is not, otherwise.
+*/
+const char *parseJob(const char *line, JobRow *r, int64_t tick_ns,
+                     const char *workload)
+{
+    char name[JOBS_WORKLOAD_MAX];
+    double arrival = 0.0;
+    char now;
+    int fields;
+
+    line += strspn(line, " \t");
+    name[0] = '\0';
+    r->deadline = PCB_NO_DEADLINE;
+    if ((now = !strncmp(line, "now", 3)))
+    {
+        fields = sscanf(line, "now, %d, %d, %d, %15[a-z]", &r->service,
+                        &r->priority, &r->deadline, name);
+        fields = fields < 0 ? 0 : fields + 1;
+    }
+    else
+    {
+        fields = sscanf(line, "%lf, %d, %d, %d, %15[a-z]", &arrival,
+                        &r->service, &r->priority, &r->deadline, name);
+    }
+    if (fields < JOBS_SPLIT_COUNT)
+        return "malformed";
+
+    /*
+    NOTE:
+        - A job with no level to go to would never leave the JDQ, so it is
+        turned away here rather than when it arrives. So is a job that
+        arrives before the run starts or asks for negative time, and one
+        whose deadline is before it arrives, which it could never meet.
+    */
+    if (r->priority < PCB_PRIORITY_0 || r->priority > PCB_PRIORITY_2)
+        return "no such priority";
+    if (arrival < 0 || r->service < 0 || r->deadline < PCB_NO_DEADLINE)
+        return "negative time";
+    if (r->deadline != PCB_NO_DEADLINE && r->deadline < arrival)
+        return "deadline before arrival";
+
+    r->workload = findWorkload(workload);
+    if (fields == JOBS_SPLIT_WORKLOAD && findWorkload(name))
+    {
+        r->workload = findWorkload(name);
+    }
+    else if (fields == JOBS_SPLIT_WORKLOAD)
+    {
+        fprintf(stderr, "WARNING: Unknown workload \"%s\", using \"%s\"\n",
+                name, workload);
+    }
+
+    r->arrival = now ? JOBS_ARRIVE_NOW : (int)floor(arrival);
+    r->offset_ns = (int64_t)((arrival - floor(arrival)) * (double)tick_ns);
+    r->held = 0;
+
+    return NULL;
+}
+
+/*
+DESCRIPTION:
+    - Creates an empty job table whose jobs pass through a reorder heap of
+    `depth` rows, or are sorted once read if `depth` is `JOBS_NO_REORDER`.
+
+RETURNS:
+    + JobTable* of the newly created table.
+    + NULL if failed at allocating memory.
+*/
+JobTable *createJobTable(int depth)
+{
+    JobTable *t;
+
+    if (!(t = (JobTable *)calloc(1, sizeof(JobTable))))
+    {
+        fprintf(stderr, "ERROR: Could not create job table\n");
+        return NULL;
+    }
+
+    if (depth > JOBS_NO_REORDER &&
+        !(t->reorder = (JobRow *)malloc(depth * sizeof(JobRow))))
+    {
+        fprintf(stderr, "ERROR: Could not create job reorder heap\n");
+        free(t);
+        return NULL;
+    }
+    t->reorder_depth = depth > JOBS_NO_REORDER ? depth : JOBS_NO_REORDER;
+
+    return t;
+}
+
+/*
+DESCRIPTION:
+    - Resizes every column of table `t` to `capacity` rows.
+
+RETURNS:
+    + TRUE if every column was resized.
+    + FALSE if failed at allocating memory. The columns that were resized
+    keep their new size, which is harmless.
+*/
+static char resizeColumns(JobTable *t, int capacity)
+{
+    void *grown;
+
+#define RESIZE_COLUMN(column)                                                  \
+    if (!(grown = realloc(t->column, capacity * sizeof(*t->column))))          \
+        return FALSE;                                                          \
+    t->column = grown;
+
+    RESIZE_COLUMN(arrival)
+    RESIZE_COLUMN(offset_ns)
+    RESIZE_COLUMN(service)
+    RESIZE_COLUMN(deadline)
+    RESIZE_COLUMN(priority)
+    RESIZE_COLUMN(workload)
+    RESIZE_COLUMN(held)
+
+#undef RESIZE_COLUMN
+
+    t->capacity = capacity;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Makes room for one more row in table `t`. The columns grow by doubling
+    when they run out of room.
+
+RETURNS:
+    + TRUE if there is room.
+    + FALSE if the table could not grow.
+*/
+static char growColumns(JobTable *t)
+{
+    if (t->count == t->capacity &&
+        !resizeColumns(t, t->capacity ? 2 * t->capacity
+                                      : JOBS_INITIAL_CAPACITY))
+    {
+        fprintf(stderr, "ERROR: Could not grow job table\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Writes job `r` into row `i` of table `t`.
+
+RETURNS:
+    + Nothing.
+*/
+static void storeRow(JobTable *t, int i, JobRow *r)
+{
+    t->arrival[i] = r->arrival;
+    t->offset_ns[i] = r->offset_ns;
+    t->service[i] = r->service;
+    t->deadline[i] = r->deadline;
+    t->priority[i] = (int8_t)r->priority;
+    t->workload[i] = r->workload;
+    t->held[i] = r->held;
+}
+
+/*
+DESCRIPTION:
+    - Adds job `r` to the end of table `t`.
+
+RETURNS:
+    + TRUE if the job was added.
+    + FALSE if the table could not grow.
+*/
+static char appendRow(JobTable *t, JobRow *r)
+{
+    if (!growColumns(t))
+        return FALSE;
+
+    storeRow(t, t->count++, r);
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Orders two jobs by arrival tick, then by how far into the tick they ar-
+    rive, then by their place in the file.
+
+RETURNS:
+    + TRUE if `a` arrives before `b`.
+    + FALSE otherwise.
+*/
+static char isBefore(JobRow *a, JobRow *b)
+{
+    if (a->arrival != b->arrival)
+        return a->arrival < b->arrival;
+    if (a->offset_ns != b->offset_ns)
+        return a->offset_ns < b->offset_ns;
+
+    return a->order < b->order;
+}
+
+/*
+DESCRIPTION:
+    - Lets job `r` out of the reorder heap into the end of table `t`. A job
+    that arrives before the last one let through is too late to take its
+    place, so it is released with that job instead. It keeps its arrival
+    time, so the ticks it was held back still count against it. How late it
+    was is counted.
+
+RETURNS:
+    + TRUE if the job was added.
+    + FALSE if the table could not grow.
+*/
+static char releaseRow(JobTable *t, JobRow *r)
+{
+    int last = t->count - 1;
+
+    if (last >= 0 && (r->arrival < t->arrival[last] ||
+                      (r->arrival == t->arrival[last] &&
+                       r->offset_ns < t->offset_ns[last])))
+    {
+        t->late++;
+        if (t->arrival[last] - r->arrival > t->most_late)
+            t->most_late = t->arrival[last] - r->arrival;
+        r->held += t->arrival[last] - r->arrival;
+        r->arrival = t->arrival[last];
+        r->offset_ns = t->offset_ns[last];
+    }
+
+    return appendRow(t, r);
+}
+
+/*
+DESCRIPTION:
+    - Moves `r` down from the root of the reorder heap until neither child
+    arrives before it.
+
+RETURNS:
+    + Nothing.
+*/
+static void siftRow(JobTable *t, JobRow *r)
+{
+    int i = 0, child;
+
+    while ((child = 2 * i + 1) < t->reorder_size)
+    {
+        if (child + 1 < t->reorder_size &&
+            isBefore(&t->reorder[child + 1], &t->reorder[child]))
+            child++;
+        if (!isBefore(&t->reorder[child], r))
+            break;
+        t->reorder[i] = t->reorder[child];
+        i = child;
+    }
+    t->reorder[i] = *r;
+}
+
+/*
+DESCRIPTION:
+    - Adds job `r` to table `t`. Once the reorder heap is full, whichever of
+    `r` and the earliest job in the heap arrives first is let through to the
+    table to make room.
+
+RETURNS:
+    + TRUE if the job was added.
+    + FALSE if the table could not grow.
+*/
+char submitJob(JobTable *t, JobRow *r)
+{
+    JobRow earliest;
+    int i, parent;
+
+    r->order = t->submitted++;
+    if (t->reorder_depth == JOBS_NO_REORDER)
+        return appendRow(t, r);
+
+    if (t->reorder_size == t->reorder_depth)
+    {
+        if (isBefore(r, &t->reorder[0]))
+            return releaseRow(t, r);
+
+        earliest = t->reorder[0];
+        siftRow(t, r);
+        return releaseRow(t, &earliest);
+    }
+
+    for (i = t->reorder_size++; i > 0; i = parent)
+    {
+        parent = (i - 1) / 2;
+        if (!isBefore(r, &t->reorder[parent]))
+            break;
+        t->reorder[i] = t->reorder[parent];
+    }
+    t->reorder[i] = *r;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Orders two rows of the table being sorted by arrival tick, then by how
+    far into the tick they arrive, then by their place in the file so that
+    jobs arriving together keep their order.
+
+RETURNS:
+    + Negative, zero or positive as per `qsort()` conventions.
+*/
+static int compareRows(const void *a, const void *b)
+{
+    int x = *(const int *)a;
+    int y = *(const int *)b;
+
+    if (sorting->arrival[x] != sorting->arrival[y])
+        return (sorting->arrival[x] > sorting->arrival[y]) -
+               (sorting->arrival[x] < sorting->arrival[y]);
+    if (sorting->offset_ns[x] != sorting->offset_ns[y])
+        return (sorting->offset_ns[x] > sorting->offset_ns[y]) -
+               (sorting->offset_ns[x] < sorting->offset_ns[y]);
+
+    return (x > y) - (x < y);
+}
+
+/*
+DESCRIPTION:
+    - Sorts the rows of table `t` by arrival. A table that is already sorted,
+    as most traces are, is left alone. Otherwise the rows are sorted as an
+    index and every column is then rearranged to match, one at a time through
+    a scratch column wide enough for any of them.
+
+RETURNS:
+    + TRUE if the table is sorted.
+    + FALSE if memory ran out, in which case it is left as it was.
+*/
+static char sortJobTable(JobTable *t)
+{
+    int *order;
+    int64_t *scratch;
+    int i;
+
+    for (i = 1; i < t->count; i++)
+    {
+        if (t->arrival[i] < t->arrival[i - 1] ||
+            (t->arrival[i] == t->arrival[i - 1] &&
+             t->offset_ns[i] < t->offset_ns[i - 1]))
+            break;
+    }
+    if (i >= t->count)
+        return TRUE;
+
+    order = (int *)malloc(t->count * sizeof(int));
+    scratch = (int64_t *)malloc(t->count * sizeof(int64_t));
+    if (!order || !scratch)
+    {
+        fprintf(stderr, "ERROR: Could not sort job table\n");
+        free(order);
+        free(scratch);
+        return FALSE;
+    }
+    for (i = 0; i < t->count; i++)
+        order[i] = i;
+    sorting = t;
+    qsort(order, t->count, sizeof(int), compareRows);
+    sorting = NULL;
+
+#define PERMUTE_COLUMN(column)                                                 \
+    for (i = 0; i < t->count; i++)                                             \
+        memcpy((char *)scratch + i * sizeof(*t->column),                       \
+               &t->column[order[i]], sizeof(*t->column));                      \
+    memcpy(t->column, scratch, t->count * sizeof(*t->column));
+
+    PERMUTE_COLUMN(arrival)
+    PERMUTE_COLUMN(offset_ns)
+    PERMUTE_COLUMN(service)
+    PERMUTE_COLUMN(deadline)
+    PERMUTE_COLUMN(priority)
+    PERMUTE_COLUMN(workload)
+    PERMUTE_COLUMN(held)
+
+#undef PERMUTE_COLUMN
+
+    free(order);
+    free(scratch);
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Puts job `r` into table `t` at its place by arrival, after any job that
+    arrives at the same instant. A job that arrives before every job still to
+    come takes the row of the last job taken, if there is one. Otherwise the
+    later rows are moved down to make room.
+
+RETURNS:
+    + TRUE if the job was added.
+    + FALSE if the table could not grow.
+*/
+char insertJob(JobTable *t, JobRow *r)
+{
+    int at = findArrivals(t, r->arrival, r->offset_ns);
+
+    if (at == t->next && t->next > 0)
+    {
+        storeRow(t, --t->next, r);
+        return TRUE;
+    }
+    if (at == t->count)
+        return appendRow(t, r);
+    if (!growColumns(t))
+        return FALSE;
+
+#define SHIFT_COLUMN(column)                                                   \
+    memmove(&t->column[at + 1], &t->column[at],                                \
+            (t->count - at) * sizeof(*t->column));
+
+    SHIFT_COLUMN(arrival)
+    SHIFT_COLUMN(offset_ns)
+    SHIFT_COLUMN(service)
+    SHIFT_COLUMN(deadline)
+    SHIFT_COLUMN(priority)
+    SHIFT_COLUMN(workload)
+    SHIFT_COLUMN(held)
+
+#undef SHIFT_COLUMN
+
+    storeRow(t, at, r);
+    t->count++;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Drops the rows of table `t` whose jobs have been taken, except for the
+    last one. A job let out of the reorder heap late is still held to it,
+    and a job submitted at run time can still take its row.
+
+RETURNS:
+    + Nothing.
+*/
+void compactJobTable(JobTable *t)
+{
+    int drop = t->next - 1;
+
+    if (drop <= 0)
+        return;
+
+#define DROP_COLUMN(column)                                                    \
+    memmove(t->column, &t->column[drop],                                       \
+            (t->count - drop) * sizeof(*t->column));
+
+    DROP_COLUMN(arrival)
+    DROP_COLUMN(offset_ns)
+    DROP_COLUMN(service)
+    DROP_COLUMN(deadline)
+    DROP_COLUMN(priority)
+    DROP_COLUMN(workload)
+    DROP_COLUMN(held)
+
+#undef DROP_COLUMN
+
+    t->count -= drop;
+    t->next = 1;
+}
+
+/*
+DESCRIPTION:
+    - Lets every job still held in the reorder heap through to table `t`,
+    once the jobs file has been read. A table read without a reorder heap is
+    sorted instead.
+
+RETURNS:
+    + TRUE if every job was added, or the table sorted.
+    + FALSE if the table could not grow or be sorted.
+*/
+char finishJobTable(JobTable *t)
+{
+    JobRow earliest;
+
+    if (t->reorder_depth == JOBS_NO_REORDER)
+        return sortJobTable(t);
+
+    while (t->reorder_size)
+    {
+        earliest = t->reorder[0];
+        if (--t->reorder_size)
+            siftRow(t, &t->reorder[t->reorder_size]);
+        if (!releaseRow(t, &earliest))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Prints how many jobs came too far out of order in the jobs file for the
+    reorder heap, and the most ticks any of them was held back by. Prints
+    nothing if every job took its place.
+
+RETURNS:
+    + Nothing.
+*/
+void printReorderStats(JobTable *t)
+{
+    if (!t->late)
+        return;
+
+    printf("Jobs beyond the reorder window: %" PRIu64
+           " (held back up to %d units)\n",
+           t->late, t->most_late);
+}
+
+/*
+DESCRIPTION:
+    - Adds line `line` of the jobs file to the quarantine list, along with
+    why it could not be turned into a job.
+
+RETURNS:
+    + Nothing.
+*/
+void quarantineJob(int line, const char *reason, const char *text)
+{
+    if (quarantine_count == quarantine_capacity)
+    {
+        int capacity = quarantine_capacity ? 2 * quarantine_capacity
+                                           : JOBS_QUARANTINE_SHOWN;
+        QuarantinedJob *grown = (QuarantinedJob *)realloc(
+            quarantined, capacity * sizeof(QuarantinedJob));
+        if (!grown)
+        {
+            fprintf(stderr, "ERROR: Could not quarantine line %d\n", line);
+            return;
+        }
+        quarantined = grown;
+        quarantine_capacity = capacity;
+    }
+
+    quarantined[quarantine_count].line = line;
+    quarantined[quarantine_count].reason = reason;
+    quarantined[quarantine_count].text = strndup(text, strcspn(text, "\r\n"));
+    quarantine_count++;
+}
+
+/*
+DESCRIPTION:
+    - Prints how many lines of the jobs file were quarantined and the first
+    few of them. Prints nothing if there were none.
+
+RETURNS:
+    + Nothing.
+*/
+void printQuarantine()
+{
+    int i;
+
+    if (!quarantine_count)
+        return;
+
+    printf("Jobs quarantined at load: %d\n", quarantine_count);
+    for (i = 0; i < quarantine_count && i < JOBS_QUARANTINE_SHOWN; i++)
+    {
+        printf("    line %d (%s): %s\n", quarantined[i].line,
+               quarantined[i].reason,
+               quarantined[i].text ? quarantined[i].text : "");
+    }
+    if (quarantine_count > JOBS_QUARANTINE_SHOWN)
+        printf("    ...\n");
+}
+
+/*
+DESCRIPTION:
+    - Counts the jobs in table `t` that have not arrived yet.
+
+RETURNS:
+    + The number of jobs left.
+*/
+int pendingJobs(JobTable *t)
+{
+    return t->count - t->next;
+}
+
+/*
+DESCRIPTION:
+    - Finds where the jobs that have arrived by `offset_ns` nanoseconds into
+    tick `timer` end, with a binary search over the arrival column from the
+    first job that has not been taken yet.
+
+RETURNS:
+    + The row of the first job still to arrive, or the row count if every
+    job has arrived.
+*/
+int findArrivals(JobTable *t, int timer, int64_t offset_ns)
+{
+    int low = t->next, high = t->count, mid;
+
+    while (low < high)
+    {
+        mid = low + (high - low) / 2;
+        if (t->arrival[mid] < timer ||
+            (t->arrival[mid] == timer && t->offset_ns[mid] <= offset_ns))
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
+/*
+DESCRIPTION:
+    - Takes the next job to arrive from table `t` and gives it a block.
+
+RETURNS:
+    + Block* of the job.
+    + NULL if no block could be created.
+*/
+Block *takeJob(JobTable *t)
+{
+    Block *p;
+    int i = t->next;
+
+    if (!(p = createNullBlock()))
+        return NULL;
+    t->next++;
+
+    p->arrival_time = t->arrival[i] - t->held[i];
+    p->deadline = t->deadline[i];
+    p->priority = t->priority[i];
+    p->remaining_cpu_time = t->service[i];
+    p->status = PCB_INITIALIZED;
+    blockInfo(p)->service_time = t->service[i];
+    setWorkload(p, t->workload[i]);
+
+    return p;
+}
+
+/*
+DESCRIPTION:
+    - Takes the next job to arrive from table `t` as a row, without giving it
+    a block.
+
+RETURNS:
+    + TRUE if a job was taken into `r`.
+    + FALSE if every job has been taken.
+*/
+char takeRow(JobTable *t, JobRow *r)
+{
+    int i = t->next;
+
+    if (i >= t->count)
+        return FALSE;
+    t->next++;
+
+    r->arrival = t->arrival[i];
+    r->offset_ns = t->offset_ns[i];
+    r->service = t->service[i];
+    r->deadline = t->deadline[i];
+    r->priority = t->priority[i];
+    r->workload = t->workload[i];
+    r->held = t->held[i];
+    r->order = (uint64_t)i;
+
+    return TRUE;
+}
@@ -0,0 +1,260 @@
+#include <launch.h>
+#include <event.h>
+#include <isolate.h>
+
+extern char **environ;
+
+/*
+NOTE:
+    - How children are launched, and the pre-opened executable for the
+    `SPAWN_FDEXEC` method. Launch latency is measured in the parent from just
+    before the call until the child's pid is known.
+*/
+static int method = SPAWN_POSIX;
+static int exec_fd = -1;
+static int null_fd = -1;
+
+/*
+NOTE:
+    - Soft RLIMIT_NPROC after raising it as far as we are allowed. It counts
+    every process of the user, not only our children, so the dispatcher can-
+    not tell from it how much room is left. Running out is only known when
+    a launch fails with EAGAIN. Launches are then held back for a while,
+    for twice as long each time it happens again, until one goes through.
+*/
+static rlim_t process_limit = RLIM_INFINITY;
+static int64_t backoff_ns = 0;
+static int64_t backoff_until = 0;
+
+static uint64_t spawn_count = 0;
+static int64_t spawn_total = 0;
+static int64_t spawn_min = 0;
+static int64_t spawn_max = 0;
+
+/*
+DESCRIPTION:
+    - Selects the launch method. For `SPAWN_FDEXEC` the executable at `path`
+    is opened once here and every child is exec'd from that descriptor, which
+    saves the path lookup and pins the binary for the whole run.
+
+RETURNS:
+    + TRUE if the method is usable.
+    + FALSE if the executable could not be opened.
+*/
+char configureSpawn(int chosen, char *path)
+{
+    struct rlimit limit;
+
+    method = chosen;
+
+    if (!getrlimit(RLIMIT_NPROC, &limit))
+    {
+        if (limit.rlim_cur < limit.rlim_max)
+        {
+            limit.rlim_cur = limit.rlim_max;
+            setrlimit(RLIMIT_NPROC, &limit);
+        }
+        process_limit = limit.rlim_cur;
+    }
+
+    if (method == SPAWN_FDEXEC)
+    {
+        if ((exec_fd = open(path, O_RDONLY | O_CLOEXEC)) < 0)
+        {
+            fprintf(stderr, "ERROR: Could not open \"%s\"\n", path);
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Sends the standard output of every child launched from now on to
+    `/dev/null`. Used when thousands of children would otherwise flood the
+    terminal.
+
+RETURNS:
+    + TRUE if `/dev/null` could be opened.
+    + FALSE otherwise.
+*/
+char silenceSpawnOutput()
+{
+    if ((null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC)) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not open /dev/null\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Checks whether launches are being held back after the last one ran
+    into the process limit.
+
+RETURNS:
+    + TRUE if another child may be launched.
+    + FALSE if launches should be deferred.
+*/
+char canSpawn()
+{
+    return !backoff_until || monotonicNanos() >= backoff_until;
+}
+
+/*
+DESCRIPTION:
+    - Holds launches back after one failed with EAGAIN, or lets them go again
+    after one went through.
+
+RETURNS:
+    + Nothing.
+*/
+static void noteLaunch(char refused)
+{
+    if (!refused)
+    {
+        backoff_ns = 0;
+        backoff_until = 0;
+        return;
+    }
+
+    backoff_ns = backoff_ns ? backoff_ns * 2
+                            : LAUNCH_BACKOFF_MIN_MS * EVENT_NANOS_PER_MILLI;
+    if (backoff_ns > LAUNCH_BACKOFF_MAX_MS * EVENT_NANOS_PER_MILLI)
+        backoff_ns = LAUNCH_BACKOFF_MAX_MS * EVENT_NANOS_PER_MILLI;
+    backoff_until = monotonicNanos() + backoff_ns;
+}
+
+/*
+DESCRIPTION:
+    - Gets the process limit the dispatcher runs under.
+
+RETURNS:
+    + The soft RLIMIT_NPROC, or 0 if unlimited.
+*/
+uint64_t getProcessLimit()
+{
+    return process_limit == RLIM_INFINITY ? 0 : (uint64_t)process_limit;
+}
+
+/*
+DESCRIPTION:
+    - Launches `args[0]` with `args` as its argument vector. SIGCHLD is blocked
+    in the dispatcher for the event loop, so every method hands the child an
+    empty signal mask before the exec.
+
+    - `SPAWN_POSIX` uses `posix_spawn()`, which glibc implements with a vfork-
+    style clone that shares the address space instead of copying page tables.
+    `SPAWN_FDEXEC` does the same by hand with `vfork()` and `fexecve()`. The
+    child does nothing but reset its mask and exec in either case. `SPAWN_FORK`
+    is the classic `fork()` and `execv()`.
+
+RETURNS:
+    + The child's process ID.
+    + -1 if the child could not be launched, with `errno` set to EAGAIN if
+    it ran into the process limit or is held back after doing so.
+*/
+pid_t spawnProcess(char **args)
+{
+    posix_spawnattr_t attr;
+    posix_spawn_file_actions_t actions;
+    sigset_t empty;
+    int64_t started, elapsed;
+    pid_t pid = -1;
+    int error;
+
+    if (!canSpawn())
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    sigemptyset(&empty);
+    fflush(stdout);
+    started = monotonicNanos();
+
+    switch (method)
+    {
+    case SPAWN_POSIX:
+        posix_spawnattr_init(&attr);
+        posix_spawnattr_setsigmask(&attr, &empty);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK);
+        posix_spawn_file_actions_init(&actions);
+        if (null_fd >= 0)
+            posix_spawn_file_actions_adddup2(&actions, null_fd, STDOUT_FILENO);
+        if ((error = posix_spawn(&pid, args[PCB_ARGS_PNAME], &actions, &attr,
+                                 args, environ)) != 0)
+        {
+            errno = error;
+            pid = -1;
+        }
+        posix_spawn_file_actions_destroy(&actions);
+        posix_spawnattr_destroy(&attr);
+        break;
+    case SPAWN_FDEXEC:
+        if ((pid = vfork()) == 0)
+        {
+            sigprocmask(SIG_SETMASK, &empty, NULL);
+            if (null_fd >= 0)
+                dup2(null_fd, STDOUT_FILENO);
+            fexecve(exec_fd, args, environ);
+            _exit(127);
+        }
+        break;
+    default:
+        if ((pid = fork()) == 0)
+        {
+            sigprocmask(SIG_SETMASK, &empty, NULL);
+            if (null_fd >= 0)
+                dup2(null_fd, STDOUT_FILENO);
+            execv(args[PCB_ARGS_PNAME], args);
+            _exit(127);
+        }
+        break;
+    }
+
+    if (pid < 0)
+    {
+        if (errno == EAGAIN)
+            noteLaunch(TRUE);
+        return -1;
+    }
+    noteLaunch(FALSE);
+
+    elapsed = monotonicNanos() - started;
+    if (!spawn_count || elapsed < spawn_min)
+        spawn_min = elapsed;
+    if (elapsed > spawn_max)
+        spawn_max = elapsed;
+    spawn_total += elapsed;
+    spawn_count++;
+
+    isolateChild(pid);
+
+    return pid;
+}
+
+/*
+DESCRIPTION:
+    - Prints the average, minimum and maximum launch latency in microseconds.
+    Prints nothing if no child was launched.
+
+RETURNS:
+    + Nothing.
+*/
+void printSpawnLatency()
+{
+    static const char *names[] = {"posix_spawn", "fork", "fdexec"};
+
+    if (!spawn_count)
+        return;
+
+    printf("Spawn latency (%s) avg/min/max: %.1f/%.1f/%.1f us over %" PRIu64
+           " launches\n",
+           names[method], (double)spawn_total / spawn_count / 1000.0,
+           (double)spawn_min / 1000.0, (double)spawn_max / 1000.0,
+           spawn_count);
+}
@@ -1,4 +1,140 @@
 #include <pcb.h>
+#include <event.h>
+#include <launch.h>
+#include <pool.h>
+#include <cgroup.h>
+#include <fiber.h>
+
+/*
+NOTE:
+    - How jobs are stopped and continued. With the cgroup executor each job
+    is frozen and thawed as a whole through its own leaf cgroup, and jobs
+    that could not be given a leaf are still driven with signals. With the
+    channel executor each job is a cooperative worker that parks and unparks
+    itself through its slot in a shared control channel. Jobs that did not
+    get a slot, such as pool workers, are driven with signals. With the
+    fiber executor jobs are not processes at all but coroutines run by the
+    dispatcher itself.
+*/
+static int executor = PCB_EXEC_SIGNAL;
+
+/*
+NOTE:
+    - Workloads `./process` can run for each tick, as passed to its `-w`.
+    Blocks point at these strings rather than owning a copy.
+*/
+static char *workloads[] = {PCB_WORKLOAD_SLEEP, PCB_WORKLOAD_SPIN, "stream",
+                            "chase", "io", NULL};
+
+/*
+DESCRIPTION:
+    - Selects the executor backend, one of the `PCB_EXEC_*` macros.
+
+RETURNS:
+    + Nothing.
+*/
+void setExecutor(int backend)
+{
+    executor = backend;
+}
+
+/*
+NOTE:
+    - Blocks and their side table are carved out of slabs of
+    `PCB_SLAB_BLOCKS` entries each, allocated as they are needed. The ID of a
+    block picks its slab and its place in it. Freed blocks are chained
+    through `next` and handed out again before a new ID is used.
+*/
+static Block *slabs[PCB_MAX_SLABS];
+static BlockInfo *infos[PCB_MAX_SLABS];
+static uint32_t block_count = 0;
+static uint32_t free_blocks = PCB_NIL;
+
+/*
+DESCRIPTION:
+    - Finds the block with ID `id`.
+
+RETURNS:
+    + Block* of the block.
+    + NULL if `id` is PCB_NIL.
+*/
+Block *blockAt(uint32_t id)
+{
+    if (id == PCB_NIL)
+        return NULL;
+
+    return &slabs[id >> PCB_SLAB_SHIFT][id & (PCB_SLAB_BLOCKS - 1)];
+}
+
+/*
+DESCRIPTION:
+    - Finds the side table entry of block `p`, which holds everything the
+    scheduler does not need on a pass over a queue.
+
+RETURNS:
+    + BlockInfo* of the entry.
+*/
+BlockInfo *blockInfo(Block *p)
+{
+    return &infos[p->id >> PCB_SLAB_SHIFT][p->id & (PCB_SLAB_BLOCKS - 1)];
+}
+
+/*
+DESCRIPTION:
+    - Follows block `p` to the one after it in its queue.
+
+RETURNS:
+    + Block* of the next block.
+    + NULL if `p` is the last one.
+*/
+Block *nextBlock(Block *p)
+{
+    return blockAt(p->next);
+}
+
+/*
+DESCRIPTION:
+    - Takes a free block ID, adding a slab to the arena when every ID handed
+    out so far is in use.
+
+RETURNS:
+    + Block* of the block with that ID.
+    + NULL if the arena is full or a slab could not be allocated.
+*/
+static Block *allocateBlock()
+{
+    Block *block;
+    uint32_t slab;
+
+    if ((block = blockAt(free_blocks)))
+    {
+        free_blocks = block->next;
+        return block;
+    }
+
+    slab = block_count >> PCB_SLAB_SHIFT;
+    if (slab >= PCB_MAX_SLABS)
+        return NULL;
+    if (!slabs[slab])
+    {
+        slabs[slab] = (Block *)aligned_alloc(PCB_SLAB_ALIGN,
+                                             PCB_SLAB_BLOCKS * sizeof(Block));
+        infos[slab] = (BlockInfo *)malloc(PCB_SLAB_BLOCKS * sizeof(BlockInfo));
+        if (!slabs[slab] || !infos[slab])
+        {
+            free(slabs[slab]);
+            free(infos[slab]);
+            slabs[slab] = NULL;
+            infos[slab] = NULL;
+            return NULL;
+        }
+    }
+
+    block = &slabs[slab][block_count & (PCB_SLAB_BLOCKS - 1)];
+    block->id = block_count++;
+
+    return block;
+}
 
 /*
 DESCRIPTION:
@@ -11,15 +147,18 @@ RETURNS:
 */
 Block *createNullBlock()
 {
+    BlockInfo *info;
     Block *block;
-    if (!(block = (Block *)malloc(sizeof(Block))))
+
+    if (!(block = allocateBlock()))
     {
         fprintf(stderr, "ERROR: Could not create new process control block\n");
         return NULL;
     }
-    block->pid = 0;
-    block->args[PCB_ARGS_PNAME] = "./process";
-    block->args[PCB_ARGS_ENDNULL] = NULL;
+    info = blockInfo(block);
+    info->pid = 0;
+    info->args[PCB_ARGS_PNAME] = "./process";
+    info->args[PCB_ARGS_ENDNULL] = NULL;
 
     /*
     NOTE:
@@ -27,11 +166,21 @@ Block *createNullBlock()
         to rework the values later on when we're working with them.
     */
     block->arrival_time = 0;
-    block->service_time = 0;
+    info->arrived_ns = 0;
+    info->service_time = 0;
+    block->deadline = PCB_NO_DEADLINE;
     block->remaining_cpu_time = 0;
     block->last_queued = -1;
     block->cycle_time = 0;
-    block->priority = 0;
+    info->first_run = PCB_NOT_RUN;
+    info->timeouts = 0;
+    info->in_cgroup = FALSE;
+    info->cpu_usec = 0;
+    info->cpu_ns = 0;
+    info->carry_ns = 0;
+    info->applied_level = PCB_LEVEL_UNSET;
+    info->slot = CHANNEL_NO_SLOT;
+    info->fiber = NULL;
 
     /*
     NOTE:
@@ -40,11 +189,98 @@ Block *createNullBlock()
     */
     block->priority = PCB_DEFAULT_PRIORITY;
     block->status = PCB_UNINITIALIZED;
-    block->next = NULL;
+    block->next = PCB_NIL;
 
     return block;
 }
 
+/*
+DESCRIPTION:
+    - Gives block `p` back to the arena. Its ID is handed out again by the
+    next `createNullBlock()`.
+
+RETURNS:
+    + Nothing.
+*/
+void freeBlock(Block *p)
+{
+    if (!p)
+        return;
+
+    p->status = PCB_UNINITIALIZED;
+    p->next = free_blocks;
+    free_blocks = p->id;
+}
+
+/*
+DESCRIPTION:
+    - Looks a workload up by name.
+
+RETURNS:
+    + The shared copy of the name, which outlives any block.
+    + NULL if there is no workload of that name.
+*/
+const char *findWorkload(const char *name)
+{
+    int i;
+
+    for (i = 0; workloads[i] && strcmp(workloads[i], name); i++)
+        ;
+
+    return workloads[i];
+}
+
+/*
+DESCRIPTION:
+    - Sets the workload the process of block `p` runs, by name. The default
+    sleeping workload needs no arguments at all.
+
+RETURNS:
+    + Block* of the process.
+    + NULL if there is no workload of that name.
+*/
+Block *setWorkload(Block *p, const char *name)
+{
+    BlockInfo *info = blockInfo(p);
+    const char *workload;
+
+    if (!(workload = findWorkload(name)))
+        return NULL;
+
+    if (!strcmp(workload, PCB_WORKLOAD_SLEEP))
+    {
+        info->args[PCB_ARGS_ENDNULL] = NULL;
+    }
+    else
+    {
+        info->args[PCB_ARGS_WORKLOAD] = PCB_WORKLOAD_FLAG;
+        info->args[PCB_ARGS_WORKLOAD + 1] = (char *)workload;
+        info->args[PCB_ARGS_WORKLOAD + 2] = NULL;
+    }
+
+    return p;
+}
+
+/*
+DESCRIPTION:
+    - Finds the name of the workload the process of block `p` runs.
+
+RETURNS:
+    + The name of the workload.
+*/
+const char *blockWorkload(Block *p)
+{
+    BlockInfo *info = blockInfo(p);
+
+    if (info->args[PCB_ARGS_WORKLOAD] &&
+        !strcmp(info->args[PCB_ARGS_WORKLOAD], PCB_WORKLOAD_FLAG))
+    {
+        return info->args[PCB_ARGS_WORKLOAD + 1];
+    }
+
+    return PCB_WORKLOAD_SLEEP;
+}
+
 /*
 DESCRIPTION:
     - Queues process (or join queues at the end of the queue). The value `q` is
@@ -55,20 +291,33 @@ RETURNS:
     + Pointer to the head of the queue.
 */
 Block *enqueueBlock(Block *q, Block *p)
+{
+    p->next = PCB_NIL;
+
+    return appendQueue(q, p);
+}
+
+/*
+DESCRIPTION:
+    - Joins the whole queue `r` to the end of queue `q` in one go.
+
+RETURNS:
+    + Pointer to the head of the joined queue.
+*/
+Block *appendQueue(Block *q, Block *r)
 {
     Block *h = q;
 
-    p->next = NULL;
+    if (!q)
+        return r;
+    if (!r)
+        return q;
 
-    if (q)
-    {
-        while (q->next)
-            q = q->next;
-        q->next = p;
-        return h;
-    }
+    while (q->next != PCB_NIL)
+        q = blockAt(q->next);
+    q->next = r->id;
 
-    return p;
+    return h;
 }
 
 /*
@@ -87,13 +336,107 @@ Block *dequeueBlock(Block **h)
 
     if (h && (p = *h))
     {
-        *h = p->next;
+        *h = blockAt(p->next);
+        p->next = PCB_NIL;
         return p;
     }
 
     return NULL;
 }
 
+/*
+DESCRIPTION:
+    - Unlinks block `p` from anywhere in the queue whose head is `h`. This is
+    for jobs that have to leave a queue out of turn.
+
+RETURNS:
+    + Block* of the removed block.
+    + NULL if the block was not in the queue.
+*/
+Block *removeBlock(Block **h, Block *p)
+{
+    Block *prev = NULL, *q;
+
+    for (q = h ? *h : NULL; q; prev = q, q = blockAt(q->next))
+    {
+        if (q == p)
+            return unlinkBlock(h, prev, p);
+    }
+
+    return NULL;
+}
+
+/*
+DESCRIPTION:
+    - Unlinks block `p`, which follows `prev` in the queue whose head is `h`,
+    or is the head itself if `prev` is NULL. This lets a walk over a queue
+    take blocks out as it goes.
+
+RETURNS:
+    + Block* of the removed block.
+*/
+Block *unlinkBlock(Block **h, Block *prev, Block *p)
+{
+    if (prev)
+        prev->next = p->next;
+    else
+        *h = blockAt(p->next);
+    p->next = PCB_NIL;
+
+    return p;
+}
+
+/*
+DESCRIPTION:
+    - Lets a stopped job run again, by thawing its cgroup if it has one and
+    with a SIGCONT otherwise. A thaw needs no confirmation from the child.
+
+RETURNS:
+    + Nothing.
+*/
+static void continueBlock(Block *p)
+{
+    BlockInfo *info = blockInfo(p);
+
+    if (info->fiber)
+        return;
+
+    if (info->slot != CHANNEL_NO_SLOT)
+    {
+        unparkSlot(info->slot);
+        return;
+    }
+
+    if (info->in_cgroup && freezeCgroup(info->pid, FALSE))
+        return;
+
+    kill(info->pid, SIGCONT);
+    expectChild(info->pid, EVENT_PENDING_CONT);
+}
+
+/*
+DESCRIPTION:
+    - Builds in `args` the arguments of block `p` followed by the channel
+    option that tells the worker its slot. `args` needs room for two more
+    entries than the arguments of `p`.
+
+RETURNS:
+    + The `args` that were passed in.
+*/
+static char **channelArgs(Block *p, char **args)
+{
+    BlockInfo *info = blockInfo(p);
+    int i;
+
+    for (i = 0; info->args[i]; i++)
+        args[i] = info->args[i];
+    args[i++] = CHANNEL_FLAG;
+    args[i++] = info->channel_arg;
+    args[i] = NULL;
+
+    return args;
+}
+
 /*
 DESCRIPTION:
     - Starts or restarts a process based on the input block `p` that is provided
@@ -105,47 +448,99 @@ RETURNS:
 */
 Block *startBlock(Block *p)
 {
-    if (!p->pid)
+    BlockInfo *info = blockInfo(p);
+
+    if (executor == PCB_EXEC_FIBER && !info->fiber)
     {
         /*
         NOTE:
-            - If the process has not yet been started so we need to fork the
-            process and start it
+            - A fiber only runs when `runBlock()` is called for it, so start-
+            ing it is just creating it. Failing to is treated like a launch
+            deferred at the process limit.
         */
-        p->pid = fork();
-        if(p->pid > 0){
-            /*
-            NOTE:
-                - We are in the parent process, we simply do nothing. Let it
-                break out of the loop naturally.
-            */
-        }else if(p->pid < 0){
-            fprintf(stderr, "FATAL: Could not fork process!\n");
-            exit(EXIT_FAILURE);
-        }else{
+        if (!(info->fiber = createFiber()))
+            return NULL;
+        p->status = PCB_RUNNING;
+
+        printBlockHeader();
+        printBlock(p);
+        fflush(stdout);
+    }
+    else if (!info->pid && !info->fiber)
+    {
+        /*
+        NOTE:
+            - If the process has not yet been started we either take a warm
+            worker from the pool, which only needs a SIGCONT, or launch a new
+            one. The child only execs, so the block header is printed by the
+            parent.
+        */
+        int64_t started = monotonicNanos();
+        pid_t pid;
+
+        if ((pid = takeWorker(info->args)) > 0)
+        {
+            info->pid = pid;
+            adoptChild(pid, p);
+            if (executor == PCB_EXEC_CGROUP)
+                info->in_cgroup = attachCgroup(pid);
+
             /*
             NOTE:
-                - We are now in the child process if the process ID is a zero.
-                This is again defined in the macros section.
+                - Whatever the worker used before it was parked is not the
+                job's, so CPU is charged from here on.
             */
-            p->pid = getpid();
-            p->status = PCB_RUNNING;
+            info->cpu_ns = sampleBlockCpu(p);
+            kill(pid, SIGCONT);
+            expectChild(pid, EVENT_PENDING_CONT);
+            recordFirstDispatch(TRUE, monotonicNanos() - started);
+        }
+        else
+        {
+            char *args[PCB_MAX_ARGS + 2];
+
+            if (executor == PCB_EXEC_CHANNEL)
+                info->slot = openSlot(info->channel_arg);
+
+            pid = spawnProcess(info->slot != CHANNEL_NO_SLOT ? channelArgs(p, args)
+                                                          : info->args);
+            if (info->slot != CHANNEL_NO_SLOT)
+            {
+                bindSlot(info->slot, pid);
+                if (pid < 0)
+                    info->slot = CHANNEL_NO_SLOT;
+            }
+
+            if (pid < 0)
+            {
+                /*
+                NOTE:
+                    - At the process limit the launch is deferred. The block
+                    stays initialized and is tried again on the next pick.
+                */
+                if (errno == EAGAIN)
+                    return NULL;
+
+                fprintf(stderr, "FATAL: Could not launch process!\n");
+                exit(EXIT_FAILURE);
+            }
+            info->pid = pid;
 
             /*
             NOTE:
-                - Print out the block header before we replace it completely w-
-                ith a different process.
+                - The child is handed to the event loop, which picks up its
+                stops and exits from now on.
             */
-            printBlockHeader();
-            printBlock(p);
-            fflush(stdout);
-
-            execv(p->args[PCB_ARGS_PNAME], p->args);
-            fprintf(stderr, "ALERT: You should never see me!\n");
-
-            exit(EXIT_FAILURE);
+            watchChild(info->pid, p);
+            if (executor == PCB_EXEC_CGROUP)
+                info->in_cgroup = attachCgroup(pid);
+            recordFirstDispatch(FALSE, monotonicNanos() - started);
         }
-        
+        p->status = PCB_RUNNING;
+
+        printBlockHeader();
+        printBlock(p);
+        fflush(stdout);
     }
     else 
     {
@@ -154,7 +549,7 @@ Block *startBlock(Block *p)
             - It's already started so just let it continue and we send a SIGCONT
             signal to notify the child process of that.
         */
-        kill(p->pid, SIGCONT);
+        continueBlock(p);
     }
 
     p->status = PCB_RUNNING;
@@ -165,7 +560,8 @@ Block *startBlock(Block *p)
 /*
 DESCRIPTION:
     - Terminates a block or a process. Sends a kill() signal to the process with
-    the given process ID.
+    the given process ID. The exit is reaped by the event loop, so the block
+    is detached from the process and may be freed right after.
 
 RETURNS:
     + Block* of the process.
@@ -173,17 +569,57 @@ RETURNS:
 */
 Block *terminateBlock(Block *p)
 {
-    int status;
+    BlockInfo *info = p ? blockInfo(p) : NULL;
 
     if (!p)
     {
         fprintf(stderr, "ERROR: Cannot terminate a NULL process\n");
         return NULL;
     }
+    else if (p->status == PCB_TERMINATED)
+    {
+        /*
+        NOTE:
+            - Already gone on its own and reaped, the pid may even have been
+            reused by now. Nothing left to signal.
+        */
+        return p;
+    }
+    else if (p->status == PCB_INITIALIZED)
+    {
+        /*
+        NOTE:
+            - Its launch was deferred and it never had a process. Signalling
+            pid 0 would hit the dispatcher's own process group.
+        */
+        p->status = PCB_TERMINATED;
+        return p;
+    }
+    else if (info->fiber)
+    {
+        destroyFiber(info->fiber);
+        info->fiber = NULL;
+        p->status = PCB_TERMINATED;
+        return p;
+    }
     else
     {
-        kill(p->pid, SIGINT);
-        waitpid(p->pid, &status, WUNTRACED);
+        /*
+        NOTE:
+            - The usage is read before the leaf is retired. Whatever else the
+            job left running in the leaf is killed when it is retired.
+        */
+        if (info->in_cgroup)
+            info->cpu_usec = readCgroupUsage(info->pid);
+
+        if (info->slot != CHANNEL_NO_SLOT)
+            exitSlot(info->slot);
+        else
+            kill(info->pid, SIGINT);
+        expectChild(info->pid, EVENT_PENDING_EXIT);
+        releaseChild(info->pid);
+        if (info->in_cgroup)
+            retireCgroup(info->pid);
         p->status = PCB_TERMINATED;
         return p;
     }
@@ -201,11 +637,11 @@ Block *resumeBlock(Block *p){
     if(!p){
         fprintf(stderr, "ERROR: Cannot resume a NULL process\n");
         return NULL;
-    }else{
+    }else if(p->status != PCB_TERMINATED){
         p->status = PCB_RUNNING;
         printBlockHeader();
         printBlock(p);
-        kill(p->pid, SIGCONT);
+        continueBlock(p);
     }
 
     return p;
@@ -213,26 +649,161 @@ Block *resumeBlock(Block *p){
 
 /*
 DESCRIPTION:
-    - Suspends/pauses a block
+    - Suspends/pauses a block. This does not wait for the child to stop, the
+    event loop collects the confirmation and reports it if it is late.
 
 RETURNS:
     + Block* of the block that was resumed.
     + NULL if couldn't resume?
 */
 Block *suspendBlock(Block *p){
-    int status;
+    BlockInfo *info = p ? blockInfo(p) : NULL;
+
     if(!p){
         fprintf(stderr, "ERROR: Cannot suspend a NULL process\n");
         return NULL;
-    }else{
-        kill(p->pid, SIGTSTP);
-        waitpid(p->pid, &status, WUNTRACED);
+    }else if(p->status == PCB_RUNNING){
+        /*
+        NOTE:
+            - A frozen cgroup stops every process in the job, including any it
+            forked, and the freezer cannot be caught or ignored.
+        */
+        if(info->fiber){
+            /*
+            NOTE:
+                - A fiber is already off the CPU whenever the dispatcher runs,
+                it is just not run again.
+            */
+        }else if(info->slot != CHANNEL_NO_SLOT){
+            parkSlot(info->slot);
+        }else if(!info->in_cgroup || !freezeCgroup(info->pid, TRUE)){
+            kill(info->pid, SIGTSTP);
+            expectChild(info->pid, EVENT_PENDING_STOP);
+        }
         p->status = PCB_SUSPENDED;
     }
 
     return p;
 }
 
+/*
+DESCRIPTION:
+    - Reads the CPU time the process of block `p` has consumed since it was
+    launched. A job in its own cgroup is read from the cgroup, which also
+    covers anything it forked. Otherwise the process CPU clock is used, and
+    `/proc/<pid>/stat` if the clock cannot be read.
+
+RETURNS:
+    + The CPU time in nanoseconds.
+    + The previous sample if the process could not be read at all, so that
+    nothing is charged for it.
+*/
+uint64_t sampleBlockCpu(Block *p)
+{
+    BlockInfo *info = blockInfo(p);
+    unsigned long utime, stime;
+    char path[64], line[512], *fields;
+    struct timespec used;
+    clockid_t clock;
+    FILE *file;
+
+    if (info->fiber)
+        return info->fiber->cpu_ns;
+
+    if (!info->pid || p->status == PCB_TERMINATED)
+        return info->cpu_ns;
+
+    if (info->in_cgroup)
+        return readCgroupUsage(info->pid) * 1000;
+
+    if (!clock_getcpuclockid(info->pid, &clock) && !clock_gettime(clock, &used))
+        return (uint64_t)used.tv_sec * 1000000000 + used.tv_nsec;
+
+    /*
+    NOTE:
+        - The command name in the stat line may contain spaces, so the fields
+        are read from after its closing parenthesis. `utime` and `stime` are
+        the 12th and 13th fields from there.
+    */
+    snprintf(path, sizeof(path), "/proc/%d/stat", (int)info->pid);
+    if (!(file = fopen(path, "r")))
+        return info->cpu_ns;
+    fields = fgets(line, sizeof(line), file) ? strrchr(line, ')') : NULL;
+    fclose(file);
+
+    if (!fields || sscanf(fields + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u "
+                                      "%*u %*u %lu %lu", &utime, &stime) != 2)
+        return info->cpu_ns;
+
+    return (uint64_t)(utime + stime) * (1000000000 / sysconf(_SC_CLK_TCK));
+}
+
+/*
+DESCRIPTION:
+    - Expresses queue level `level` through the kernel scheduler for the pro-
+    cess of block `p`. Level 0 is boosted above the default nice value, level
+    1 is niced down and level 2 only runs under SCHED_IDLE, when nothing else
+    wants the CPU. Nothing is done if the level has not changed.
+
+    - Boosting needs privileges. Without them the process keeps whatever
+    priority it had, and a warning is printed the first time.
+
+RETURNS:
+    + Block* of the process.
+*/
+Block *prioritizeBlock(Block *p, int level)
+{
+    BlockInfo *info = blockInfo(p);
+    static char warned = FALSE;
+    struct sched_param param = {0};
+    char applied;
+
+    if (!info->pid || info->applied_level == level)
+        return p;
+
+    if (level == PCB_PRIORITY_2)
+    {
+        applied = !sched_setscheduler(info->pid, SCHED_IDLE, &param);
+    }
+    else
+    {
+        applied = (info->applied_level != PCB_PRIORITY_2 ||
+                   !sched_setscheduler(info->pid, SCHED_OTHER, &param)) &&
+                  !setpriority(PRIO_PROCESS, info->pid,
+                               level == PCB_PRIORITY_0 ? PCB_NICE_0
+                                                       : PCB_NICE_1);
+    }
+
+    if (!applied && !warned)
+    {
+        fprintf(stderr, "WARNING: Could not set kernel priority of process "
+                        "%d for level %d\n",
+                (int)info->pid, level);
+        warned = TRUE;
+    }
+    info->applied_level = level;
+
+    return p;
+}
+
+/*
+DESCRIPTION:
+    - Gives block `p` the CPU until the monotonic clock reaches `until`. Only
+    fibers need this, a process runs on its own once it has been continued.
+
+RETURNS:
+    + Block* of the process.
+*/
+Block *runBlock(Block *p, int64_t until)
+{
+    BlockInfo *info = blockInfo(p);
+
+    if (info->fiber && p->status == PCB_RUNNING)
+        runFiber(info->fiber, until);
+
+    return p;
+}
+
 /*
 DESCRIPTION:
     - Prints process attributes to standard output.
@@ -242,8 +813,10 @@ RETURNS:
 */
 Block *printBlock(Block *p)
 {
+    BlockInfo *info = blockInfo(p);
+
     printf("%7d%7d%9d%12d%13d%10d    ",
-           (int)p->pid, p->arrival_time, p->service_time,
+           (int)info->pid, p->arrival_time, info->service_time,
            p->remaining_cpu_time, p->last_queued, p->priority);
 
     switch (p->status)
@@ -0,0 +1,238 @@
+#include <pool.h>
+#include <event.h>
+#include <launch.h>
+
+/*
+NOTE:
+    - Pre-launched workers waiting for their first job. Each one has already
+    exec'd `./process` and was stopped with SIGSTOP straight away, so handing
+    it a job costs a single SIGCONT.
+*/
+static pid_t *workers = NULL;
+static int worker_count = 0;
+static int worker_max = 0;
+static char *worker_args[PCB_MAX_ARGS];
+
+/*
+NOTE:
+    - Arrival rate in jobs per tick, smoothed over the ticks seen so far. The
+    pool is kept large enough to cover the jobs expected over the next few
+    ticks.
+*/
+static double arrival_rate = 0.0;
+static uint64_t arrivals = 0;
+static uint64_t last_refill = 0;
+
+static uint64_t hits = 0, misses = 0;
+static int64_t hit_total = 0, miss_total = 0;
+
+/*
+DESCRIPTION:
+    - Sets up a pool of at most `max` workers launched with `args`. The pool
+    keeps copies of the strings themselves, as the block they come from can
+    be freed long before the pool stops launching. A size of zero leaves the
+    pool disabled.
+
+RETURNS:
+    + TRUE if the pool is ready or disabled.
+    + FALSE if failed at allocating memory.
+*/
+char initializePool(int max, char **args)
+{
+    int i;
+
+    if (max <= 0)
+        return TRUE;
+
+    if (!(workers = (pid_t *)malloc(max * sizeof(pid_t))))
+    {
+        fprintf(stderr, "ERROR: Could not create worker pool\n");
+        return FALSE;
+    }
+
+    for (i = 0; i < PCB_MAX_ARGS - 1 && args[i]; i++)
+    {
+        if (!(worker_args[i] = strdup(args[i])))
+        {
+            fprintf(stderr, "ERROR: Could not create worker pool\n");
+            return FALSE;
+        }
+    }
+    worker_args[i] = NULL;
+    worker_max = max;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Counts one job arrival towards the arrival rate estimate.
+
+RETURNS:
+    + Nothing.
+*/
+void noteArrival()
+{
+    arrivals++;
+}
+
+/*
+DESCRIPTION:
+    - Drops worker `i` from the pool by moving the last worker into its slot.
+
+RETURNS:
+    + The process ID of the dropped worker.
+*/
+static pid_t dropWorker(int i)
+{
+    pid_t pid = workers[i];
+
+    workers[i] = workers[--worker_count];
+
+    return pid;
+}
+
+/*
+DESCRIPTION:
+    - Updates the arrival rate and tops the pool up towards the number of jobs
+    expected over the next `POOL_LEAD_TICKS` ticks. At most `POOL_REFILL_BATCH`
+    workers are launched per call so a refill never holds up a tick for long.
+    Workers that died while waiting are dropped first.
+
+RETURNS:
+    + Nothing.
+*/
+void refillPool(uint64_t timer)
+{
+    int target, launched = 0, i;
+    pid_t pid;
+
+    if (!worker_max)
+        return;
+
+    if (timer > last_refill)
+    {
+        arrival_rate = POOL_RATE_WEIGHT * arrivals / (timer - last_refill) +
+                       (1.0 - POOL_RATE_WEIGHT) * arrival_rate;
+        arrivals = 0;
+        last_refill = timer;
+    }
+
+    for (i = worker_count - 1; i >= 0; i--)
+    {
+        if (!isChildAlive(workers[i]))
+            dropWorker(i);
+    }
+
+    target = (int)(arrival_rate * POOL_LEAD_TICKS + 0.999) + 1;
+    if (target > worker_max)
+        target = worker_max;
+
+    while (worker_count < target && launched < POOL_REFILL_BATCH &&
+           canSpawn())
+    {
+        if ((pid = spawnProcess(worker_args)) < 0)
+        {
+            if (errno != EAGAIN)
+                fprintf(stderr, "ERROR: Could not launch pool worker\n");
+            return;
+        }
+        watchChild(pid, NULL);
+        kill(pid, SIGSTOP);
+        expectChild(pid, EVENT_PENDING_STOP);
+
+        workers[worker_count++] = pid;
+        launched++;
+    }
+}
+
+/*
+DESCRIPTION:
+    - Takes a worker that has confirmed it is stopped out of the pool, for a
+    job launched with `args`. Workers all run the pool's arguments, so jobs
+    with any other arguments cannot use them.
+
+RETURNS:
+    + The worker's process ID.
+    + -1 if no stopped worker is available or the arguments differ.
+*/
+pid_t takeWorker(char **args)
+{
+    int i;
+
+    for (i = 0; args[i] || worker_args[i]; i++)
+    {
+        if (!args[i] || !worker_args[i] || strcmp(args[i], worker_args[i]))
+            return -1;
+    }
+
+    for (i = 0; i < worker_count; i++)
+    {
+        if (isChildStopped(workers[i]))
+            return dropWorker(i);
+    }
+
+    return -1;
+}
+
+/*
+DESCRIPTION:
+    - Records how long the first dispatch of a job took, split by whether it
+    was served from the pool (`hit`) or had to launch a new process.
+
+RETURNS:
+    + Nothing.
+*/
+void recordFirstDispatch(char hit, int64_t elapsed)
+{
+    if (hit)
+    {
+        hits++;
+        hit_total += elapsed;
+    }
+    else
+    {
+        misses++;
+        miss_total += elapsed;
+    }
+}
+
+/*
+DESCRIPTION:
+    - Kills every worker that never got a job. SIGKILL is used since the
+    workers are stopped and would not act on anything else.
+
+RETURNS:
+    + Nothing.
+*/
+void drainPool()
+{
+    pid_t pid;
+
+    while (worker_count)
+    {
+        pid = dropWorker(worker_count - 1);
+        kill(pid, SIGKILL);
+        expectChild(pid, EVENT_PENDING_EXIT);
+    }
+}
+
+/*
+DESCRIPTION:
+    - Prints how many first dispatches were served by the pool and the aver-
+    age first-dispatch latency with and without it. Prints nothing if the
+    pool is disabled.
+
+RETURNS:
+    + Nothing.
+*/
+void printPoolStats()
+{
+    if (!worker_max)
+        return;
+
+    printf("Pool first dispatches: %" PRIu64 " hits (avg %.1f us), %" PRIu64
+           " misses (avg %.1f us)\n",
+           hits, hits ? (double)hit_total / hits / 1000.0 : 0.0,
+           misses, misses ? (double)miss_total / misses / 1000.0 : 0.0);
+}
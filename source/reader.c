@@ -0,0 +1,445 @@
+#include <reader.h>
+
+/*
+NOTE:
+    - The jobs file is read and put in order on a thread of its own while
+    the dispatcher schedules. Jobs reach the dispatcher through `ring`, and
+    the reader waits once the ring is full. `staged` is where the reader
+    puts them in order, and only ever holds what has not been published.
+*/
+static JobRing ring;
+static JobTable *staged = NULL;
+static FILE *trace = NULL;
+static pthread_t reader_thread;
+static char reader_open = FALSE;
+static char trace_ended = FALSE;
+static char trace_failed = FALSE;
+
+static int64_t tick_ns = 0;
+static const char *default_workload = NULL;
+
+static uint64_t read_rows = 0;
+static uint64_t popped = 0;
+static uint64_t taken = 0;
+static uint64_t reader_stalls = 0;
+static uint64_t dispatcher_waits = 0;
+static int64_t dispatcher_wait_ns = 0;
+
+/*
+DESCRIPTION:
+    - Sleeps on futex word `word` for as long as it still holds `value`.
+
+RETURNS:
+    + Nothing.
+*/
+static void waitWord(uint32_t *word, uint32_t value)
+{
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, value, NULL, NULL, 0);
+}
+
+/*
+DESCRIPTION:
+    - Wakes the thread sleeping on futex word `word`.
+
+RETURNS:
+    + Nothing.
+*/
+static void wakeWord(uint32_t *word)
+{
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+}
+
+/*
+DESCRIPTION:
+    - Publishes job `r` to the dispatcher. Only the reader calls this. While
+    the ring is full the reader sleeps, and it is only woken once half of
+    the ring is free again.
+
+RETURNS:
+    + Nothing.
+*/
+static void pushRow(JobRow *r)
+{
+    uint32_t head = ring.head, tail;
+
+    /*
+    NOTE:
+        - The flag is raised before the ring is looked at again, and the dis-
+        patcher moves `tail` before it looks at the flag. One of the two al-
+        ways sees the other, so a wake-up is never lost.
+    */
+    while (head - __atomic_load_n(&ring.tail, __ATOMIC_ACQUIRE) ==
+           READER_RING_SIZE)
+    {
+        __atomic_store_n(&ring.reader_waiting, TRUE, __ATOMIC_SEQ_CST);
+        tail = __atomic_load_n(&ring.tail, __ATOMIC_SEQ_CST);
+        if (head - tail == READER_RING_SIZE)
+        {
+            reader_stalls++;
+            waitWord(&ring.tail, tail);
+        }
+        __atomic_store_n(&ring.reader_waiting, FALSE, __ATOMIC_RELAXED);
+    }
+
+    ring.rows[head & READER_RING_MASK] = *r;
+    __atomic_store_n(&ring.head, head + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring.dispatcher_waiting, __ATOMIC_SEQ_CST))
+        wakeWord(&ring.head);
+}
+
+/*
+DESCRIPTION:
+    - Takes the next job from the reader into `r`. Only the dispatcher calls
+    this. While the ring is empty the dispatcher sleeps, and the time it
+    spends asleep is counted.
+
+RETURNS:
+    + TRUE if a job was taken.
+    + FALSE at the end of the trace.
+*/
+static char popRow(JobRow *r)
+{
+    uint32_t tail = ring.tail, head;
+    int64_t start = 0;
+
+    while (__atomic_load_n(&ring.head, __ATOMIC_ACQUIRE) == tail)
+    {
+        __atomic_store_n(&ring.dispatcher_waiting, TRUE, __ATOMIC_SEQ_CST);
+        head = __atomic_load_n(&ring.head, __ATOMIC_SEQ_CST);
+        if (head == tail)
+        {
+            if (!start)
+            {
+                start = monotonicNanos();
+                dispatcher_waits++;
+            }
+            waitWord(&ring.head, head);
+        }
+        __atomic_store_n(&ring.dispatcher_waiting, FALSE, __ATOMIC_RELAXED);
+    }
+    if (start)
+        dispatcher_wait_ns += monotonicNanos() - start;
+
+    *r = ring.rows[tail & READER_RING_MASK];
+    __atomic_store_n(&ring.tail, tail + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&ring.reader_waiting, __ATOMIC_SEQ_CST) &&
+        __atomic_load_n(&ring.head, __ATOMIC_RELAXED) - (tail + 1) <=
+            READER_RING_SIZE / 2)
+    {
+        wakeWord(&ring.tail);
+    }
+
+    if (r->order == READER_END_OF_TRACE || r->order == READER_TRACE_FAILED)
+    {
+        trace_ended = TRUE;
+        trace_failed = r->order == READER_TRACE_FAILED;
+        return FALSE;
+    }
+    popped++;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Publishes every job that has come out of the reorder heap so far. The
+    rows they took are dropped once there are enough of them.
+
+RETURNS:
+    + Nothing.
+*/
+static void publishRows()
+{
+    JobRow row;
+
+    while (takeRow(staged, &row))
+        pushRow(&row);
+
+    if (staged->next > JOBS_INITIAL_CAPACITY)
+        compactJobTable(staged);
+}
+
+/*
+DESCRIPTION:
+    - Body of the reader thread. Reads the jobs file a line at a time and
+    publishes the jobs in arrival order as soon as the reorder heap lets
+    them through. Without a reorder heap nothing can be published until the
+    whole file is read and sorted. The end of the trace is published last,
+    whatever happens, and says whether the whole file made it through.
+
+RETURNS:
+    + NULL.
+*/
+static void *readTrace(void *unused)
+{
+    JobRow row;
+    const char *reason;
+    char line[JOBS_LINE_MAX];
+    int line_no = 0, c, rest;
+    char loaded = TRUE;
+
+    (void)unused;
+
+    while (fgets(line, sizeof(line), trace))
+    {
+        line_no++;
+
+        /*
+        NOTE:
+            - A line too long for `line` is quarantined whole. The rest of
+            it is thrown away up to its newline, rather than read as a line
+            of its own.
+        */
+        if (!strchr(line, '\n') && !feof(trace))
+        {
+            for (rest = 0; (c = getc(trace)) != EOF && c != '\n'; rest++)
+                ;
+            if (rest)
+            {
+                quarantineJob(line_no, "too long", line);
+                continue;
+            }
+        }
+        if (line[strspn(line, " \t\r\n")] == '\0')
+            continue;
+
+        /*
+        NOTE:
+            - A line that does not make a job is quarantined and we go to the
+            next input. Only jobs submitted while the dispatcher runs can
+            leave their arrival time to the dispatcher.
+        */
+        if (!(reason = parseJob(line, &row, tick_ns, default_workload)) &&
+            row.arrival == JOBS_ARRIVE_NOW)
+        {
+            reason = "no arrival time";
+        }
+        if (reason)
+        {
+            quarantineJob(line_no, reason, line);
+            continue;
+        }
+
+        if (!submitJob(staged, &row))
+        {
+            loaded = FALSE;
+            break;
+        }
+        __atomic_add_fetch(&read_rows, 1, __ATOMIC_RELAXED);
+        if (staged->reorder_depth != JOBS_NO_REORDER)
+            publishRows();
+    }
+
+    fclose(trace);
+    trace = NULL;
+    /*
+    NOTE:
+        - Without a reorder heap a table that could not be read whole or
+        sorted is not published at all. Its rows need not be in arrival
+        order, which everything after the reader relies on.
+    */
+    if (loaded)
+        loaded = finishJobTable(staged);
+    if (loaded || staged->reorder_depth != JOBS_NO_REORDER)
+        publishRows();
+
+    memset(&row, 0, sizeof(row));
+    row.order = loaded ? READER_END_OF_TRACE : READER_TRACE_FAILED;
+    pushRow(&row);
+
+    return NULL;
+}
+
+/*
+DESCRIPTION:
+    - Opens jobs file `filename` and starts reading it on a thread of its
+    own, through a reorder heap of `depth` rows. Ticks are `tick` nanoseconds
+    long, and a job that names no workload gets `workload`.
+
+RETURNS:
+    + TRUE if the reader is running.
+    + FALSE if the file could not be opened or the thread started.
+*/
+char openReader(const char *filename, int depth, int64_t tick,
+                const char *workload)
+{
+    sigset_t all, old;
+    int error;
+
+    if (!(trace = fopen(filename, "r")))
+        return FALSE;
+    if (!(staged = createJobTable(depth)))
+    {
+        fclose(trace);
+        return FALSE;
+    }
+    tick_ns = tick;
+    default_workload = workload;
+
+    /*
+    NOTE:
+        - The reader blocks every signal. A signal meant for the dispatcher's
+        event loop could otherwise be delivered to it instead.
+    */
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    error = pthread_create(&reader_thread, NULL, readTrace, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (error)
+    {
+        fprintf(stderr, "ERROR: Could not start the trace reader: %s\n",
+                strerror(error));
+        fclose(trace);
+        return FALSE;
+    }
+    reader_open = TRUE;
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Moves jobs from the reader into table `t` until it holds every job that
+    arrives by tick `timer` and the first one that arrives after, waiting on
+    the reader if it has to. Everything later is left to the reader, which
+    waits in turn once the ring is full. The rows of jobs already taken from
+    `t` are dropped now and then, so the table does not grow with the trace.
+
+RETURNS:
+    + The number of jobs moved into `t`.
+*/
+int pullJobs(JobTable *t, uint64_t timer)
+{
+    JobRow row;
+    int pulled = 0;
+
+    if (!reader_open || trace_ended)
+        return 0;
+    if (t->next > JOBS_INITIAL_CAPACITY && t->next > pendingJobs(t))
+        compactJobTable(t);
+
+    while (!pendingJobs(t) || (uint64_t)t->arrival[t->count - 1] <= timer)
+    {
+        if (!popRow(&row) || !insertJob(t, &row))
+            break;
+        pulled++;
+    }
+    taken += pulled;
+
+    return pulled;
+}
+
+/*
+DESCRIPTION:
+    - Takes the next `count` jobs from the reader and throws them away, for a
+    run that resumes from a checkpoint and already has them. The trace is
+    read again from the start and put in the same order as before, as long
+    as the reorder depth is the same.
+
+RETURNS:
+    + The number of jobs thrown away, fewer than `count` if the trace ended
+    first.
+*/
+uint64_t skipJobs(uint64_t count)
+{
+    JobRow row;
+    uint64_t skipped = 0;
+
+    if (!reader_open)
+        return 0;
+
+    while (skipped < count && !trace_ended && popRow(&row))
+        skipped++;
+    taken += skipped;
+
+    return skipped;
+}
+
+/*
+DESCRIPTION:
+    - Counts the jobs taken from the reader so far, whether they were pulled
+    or skipped.
+
+RETURNS:
+    + The number of jobs.
+*/
+uint64_t takenJobs()
+{
+    return taken;
+}
+
+/*
+DESCRIPTION:
+    - Counts the jobs read from the jobs file that the dispatcher has not
+    taken from the reader yet, whether they wait in the reorder heap or in
+    the ring. Only the dispatcher calls this.
+
+RETURNS:
+    + The number of jobs.
+*/
+uint64_t readerBacklog()
+{
+    uint64_t read = __atomic_load_n(&read_rows, __ATOMIC_RELAXED);
+
+    return read > popped ? read - popped : 0;
+}
+
+/*
+DESCRIPTION:
+    - Tells whether the reader gave up before the end of the jobs file, once
+    it has said so.
+
+RETURNS:
+    + TRUE if the jobs file was not read whole.
+    + FALSE otherwise.
+*/
+char readerFailed()
+{
+    return trace_failed;
+}
+
+/*
+DESCRIPTION:
+    - Stops the reader. Whatever it still has to publish is taken and thrown
+    away, so that it can finish.
+
+RETURNS:
+    + Nothing.
+*/
+void closeReader()
+{
+    JobRow row;
+
+    if (!reader_open)
+        return;
+
+    while (!trace_ended && popRow(&row))
+        ;
+    pthread_join(reader_thread, NULL);
+    reader_open = FALSE;
+}
+
+/*
+DESCRIPTION:
+    - Prints how the jobs file was put in order, and how often either side
+    of the ring had to wait for the other. Prints nothing if no jobs file
+    was read.
+
+RETURNS:
+    + Nothing.
+*/
+void printReaderStats()
+{
+    if (!staged)
+        return;
+
+    printReorderStats(staged);
+    if (dispatcher_waits)
+    {
+        printf("Waits on the trace reader: %" PRIu64 " (%.3f ms)\n",
+               dispatcher_waits,
+               (double)dispatcher_wait_ns / (double)EVENT_NANOS_PER_MILLI);
+    }
+    if (reader_stalls)
+        printf("Trace reader held back: %" PRIu64 " times\n", reader_stalls);
+}
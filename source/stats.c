@@ -0,0 +1,186 @@
+#include <stats.h>
+
+/*
+NOTE:
+    - The stats endpoint is a listening Unix socket watched by the event loop.
+    Every client that connects is sent one snapshot of the scheduler and the
+    connection is closed. The snapshot itself is written by whoever opened
+    the socket, since only they can see the queues.
+*/
+static int stats_fd = -1;
+static char stats_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static size_t (*write_snapshot)(char *, size_t) = NULL;
+static uint64_t served = 0;
+
+static LevelMoves moves[STATS_RECENT_TICKS];
+
+/*
+DESCRIPTION:
+    - Accepts every client waiting on the stats socket `fd` and sends each the
+    same snapshot, written once for the lot. Both the socket and the clients
+    are non-blocking, and a snapshot fits in a socket buffer, so a client
+    that does not read never holds up the dispatcher.
+
+RETURNS:
+    + Nothing.
+*/
+static void serveStats(int fd)
+{
+    static char buffer[STATS_BUFFER_SIZE];
+    size_t length = 0;
+    int client;
+
+    while ((client = accept4(fd, NULL, NULL,
+                             SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+    {
+        if (!length)
+            length = write_snapshot(buffer, sizeof(buffer));
+        if (send(client, buffer, length, MSG_NOSIGNAL) < 0)
+            fprintf(stderr, "WARNING: Could not send stats snapshot\n");
+        close(client);
+        served++;
+    }
+}
+
+/*
+DESCRIPTION:
+    - Opens the stats endpoint as a Unix socket at `path`, replacing a socket
+    already there, and has the event loop serve it. `snapshot` writes a
+    snapshot into a buffer and returns its length.
+
+RETURNS:
+    + TRUE if the endpoint is open.
+    + FALSE if the socket could not be set up, or something other than a
+    socket is at `path`.
+*/
+char openStatsSocket(const char *path, size_t (*snapshot)(char *, size_t))
+{
+    struct sockaddr_un address;
+    struct stat existing;
+
+    if (strlen(path) >= sizeof(address.sun_path))
+    {
+        fprintf(stderr, "ERROR: Stats socket path is too long\n");
+        return FALSE;
+    }
+
+    /*
+    NOTE:
+        - Only a socket left behind by an earlier run is replaced. Anything
+        else at `path` is left alone.
+    */
+    if (!lstat(path, &existing) && !S_ISSOCK(existing.st_mode))
+    {
+        fprintf(stderr, "ERROR: \"%s\" exists and is not a socket\n", path);
+        return FALSE;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    if ((stats_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                           0)) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not create stats socket\n");
+        return FALSE;
+    }
+    unlink(path);
+    if (bind(stats_fd, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+        listen(stats_fd, STATS_BACKLOG) < 0)
+    {
+        fprintf(stderr, "ERROR: Could not listen on \"%s\": %s\n", path,
+                strerror(errno));
+        close(stats_fd);
+        stats_fd = -1;
+        return FALSE;
+    }
+
+    strcpy(stats_path, path);
+    write_snapshot = snapshot;
+    if (!watchDescriptor(stats_fd, serveStats))
+    {
+        closeStatsSocket();
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Closes the stats endpoint and removes its socket file.
+
+RETURNS:
+    + Nothing.
+*/
+void closeStatsSocket()
+{
+    if (stats_fd < 0)
+        return;
+
+    unwatchDescriptor(stats_fd);
+    close(stats_fd);
+    unlink(stats_path);
+    stats_fd = -1;
+}
+
+/*
+DESCRIPTION:
+    - Counts `promoted` promotions and `demoted` demotions towards tick `tick`.
+
+RETURNS:
+    + Nothing.
+*/
+void noteLevelMoves(uint64_t tick, int promoted, int demoted)
+{
+    LevelMoves *slot = &moves[tick % STATS_RECENT_TICKS];
+
+    if (slot->tick != tick)
+    {
+        slot->tick = tick;
+        slot->promoted = 0;
+        slot->demoted = 0;
+    }
+    slot->promoted += promoted;
+    slot->demoted += demoted;
+}
+
+/*
+DESCRIPTION:
+    - Adds up the promotions and demotions over the last STATS_RECENT_TICKS
+    ticks up to `now`.
+
+RETURNS:
+    + Nothing. The sums are stored in `promoted` and `demoted`.
+*/
+void recentLevelMoves(uint64_t now, uint64_t *promoted, uint64_t *demoted)
+{
+    int i;
+
+    *promoted = 0;
+    *demoted = 0;
+    for (i = 0; i < STATS_RECENT_TICKS; i++)
+    {
+        if (moves[i].tick > now || now - moves[i].tick >= STATS_RECENT_TICKS)
+            continue;
+        *promoted += moves[i].promoted;
+        *demoted += moves[i].demoted;
+    }
+}
+
+/*
+DESCRIPTION:
+    - Prints how many stats snapshots were served. Prints nothing if none
+    were.
+
+RETURNS:
+    + Nothing.
+*/
+void printStatsServed()
+{
+    if (!served)
+        return;
+
+    printf("Stats snapshots served: %" PRIu64 "\n", served);
+}
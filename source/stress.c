@@ -0,0 +1,352 @@
+#include <stress.h>
+#include <event.h>
+#include <launch.h>
+#include <fiber.h>
+
+/*
+DESCRIPTION:
+    - Measures the per-child cost of a bulk continue and a bulk stop over the
+    `n` children in `pids`, including collecting every confirmation.
+
+RETURNS:
+    + Nothing. The averages in microseconds are written to `cont_us` and
+    `stop_us`.
+*/
+static void measureSwitches(pid_t *pids, int n, double *cont_us, double *stop_us)
+{
+    int64_t started;
+
+    started = monotonicNanos();
+    signalChildren(pids, n, SIGCONT, EVENT_PENDING_CONT);
+    awaitPending();
+    *cont_us = (double)(monotonicNanos() - started) / n / 1000.0;
+
+    started = monotonicNanos();
+    signalChildren(pids, n, SIGSTOP, EVENT_PENDING_STOP);
+    awaitPending();
+    *stop_us = (double)(monotonicNanos() - started) / n / 1000.0;
+}
+
+/*
+DESCRIPTION:
+    - Measures the average time to look a child up by pid in the event loop's
+    table, over random live children.
+
+RETURNS:
+    + The average lookup time in nanoseconds.
+*/
+static double measureLookups(pid_t *pids, int n)
+{
+    int64_t started = monotonicNanos();
+    int found = 0, i;
+
+    for (i = 0; i < STRESS_LOOKUPS; i++)
+        found += isChildAlive(pids[rand() % n]);
+
+    if (found != STRESS_LOOKUPS)
+        fprintf(stderr, "WARNING: %d children went missing\n",
+                STRESS_LOOKUPS - found);
+
+    return (double)(monotonicNanos() - started) / STRESS_LOOKUPS;
+}
+
+/*
+DESCRIPTION:
+    - Stress mode. Grows a population of `count` stopped `args[0]` children,
+    doubling from `STRESS_FIRST_CHECKPOINT`. At every checkpoint it prints the
+    average launch latency of the last batch, the per-child cost of a bulk
+    continue and stop over a sample, and the pid lookup time. Growth stops
+    early at the process limit or on any launch failure. Every child is killed at the end.
+
+RETURNS:
+    + The number of children that were kept alive at the peak.
+*/
+int runStress(int count, char **args)
+{
+    pid_t *pids;
+    int live = 0, checkpoint = STRESS_FIRST_CHECKPOINT, batch_start;
+    int64_t started, batch_total;
+    double cont_us, stop_us;
+    pid_t pid;
+
+    if (!(pids = (pid_t *)malloc(count * sizeof(pid_t))))
+    {
+        fprintf(stderr, "ERROR: Could not allocate stress population\n");
+        return 0;
+    }
+
+    if (getProcessLimit())
+        printf("Process limit: %" PRIu64 "\n", getProcessLimit());
+    else
+        printf("Process limit: unlimited\n");
+    printf("%10s%12s%12s%12s%12s\n", "children", "spawn_us", "cont_us",
+           "stop_us", "lookup_ns");
+
+    while (live < count)
+    {
+        if (checkpoint > count)
+            checkpoint = count;
+
+        batch_start = live;
+        batch_total = 0;
+        while (live < checkpoint)
+        {
+            started = monotonicNanos();
+            if ((pid = spawnProcess(args)) < 0)
+            {
+                if (errno != EAGAIN)
+                    perror("ERROR: Could not launch stress child");
+                break;
+            }
+            batch_total += monotonicNanos() - started;
+
+            watchChild(pid, NULL);
+            kill(pid, SIGSTOP);
+            expectChild(pid, EVENT_PENDING_STOP);
+            pids[live++] = pid;
+        }
+        awaitPending();
+
+        if (live == batch_start)
+            break;
+
+        measureSwitches(pids, live < STRESS_SAMPLE ? live : STRESS_SAMPLE,
+                        &cont_us, &stop_us);
+        printf("%10d%12.1f%12.1f%12.1f%12.1f\n", live,
+               (double)batch_total / (live - batch_start) / 1000.0,
+               cont_us, stop_us, measureLookups(pids, live));
+        fflush(stdout);
+
+        if (live < checkpoint)
+        {
+            printf("Stopped growing at %d children\n", live);
+            break;
+        }
+        checkpoint *= 2;
+    }
+
+    signalChildren(pids, live, SIGKILL, EVENT_PENDING_EXIT);
+    while (countChildren())
+        awaitChildren();
+    free(pids);
+
+    return live;
+}
+
+/*
+DESCRIPTION:
+    - Reads the resident set size of the dispatcher.
+
+RETURNS:
+    + The resident set size in kilobytes.
+    + 0 if it could not be read.
+*/
+static long residentKilobytes()
+{
+    long pages = 0;
+    FILE *file;
+
+    if (!(file = fopen("/proc/self/statm", "r")))
+        return 0;
+    if (fscanf(file, "%*s %ld", &pages) != 1)
+        pages = 0;
+    fclose(file);
+
+    return pages * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+/*
+DESCRIPTION:
+    - Fiber stress mode. Grows a population of `count` fibers, doubling from
+    `STRESS_FIRST_CHECKPOINT`. At every checkpoint every fiber is run for one
+    chunk in turn, and it prints the average creation time of the last batch,
+    the average time of one such turn (a chunk of the kernel plus the switch
+    into the fiber and back) and the resident size of the dispatcher.
+
+RETURNS:
+    + The number of fibers that were created.
+*/
+int runFiberStress(int count)
+{
+    Fiber **fibers;
+    int live = 0, checkpoint = STRESS_FIRST_CHECKPOINT, batch_start, i;
+    int64_t started, batch_total;
+
+    if (!(fibers = (Fiber **)malloc(count * sizeof(Fiber *))))
+    {
+        fprintf(stderr, "ERROR: Could not allocate stress population\n");
+        return 0;
+    }
+
+    printf("%10s%12s%12s%12s\n", "fibers", "create_us", "turn_us",
+           "rss_kb");
+
+    while (live < count)
+    {
+        if (checkpoint > count)
+            checkpoint = count;
+
+        batch_start = live;
+        started = monotonicNanos();
+        while (live < checkpoint && (fibers[live] = createFiber()))
+            live++;
+        batch_total = monotonicNanos() - started;
+
+        if (live == batch_start)
+            break;
+
+        /*
+        NOTE:
+            - A slice that has already ended makes each fiber yield after a
+            single chunk, so this is one round trip per fiber.
+        */
+        started = monotonicNanos();
+        for (i = 0; i < live; i++)
+            runFiber(fibers[i], 0);
+
+        printf("%10d%12.2f%12.2f%12ld\n", live,
+               (double)batch_total / (live - batch_start) / 1000.0,
+               (double)(monotonicNanos() - started) / live / 1000.0,
+               residentKilobytes());
+        fflush(stdout);
+
+        if (live < checkpoint)
+        {
+            printf("Stopped growing at %d fibers\n", live);
+            break;
+        }
+        checkpoint *= 2;
+    }
+
+    for (i = 0; i < live; i++)
+        destroyFiber(fibers[i]);
+    free(fibers);
+
+    return live;
+}
+
+/*
+DESCRIPTION:
+    - Links the `n` blocks in `blocks` into one queue in a random order, the
+    way a queue ends up after jobs have been demoted and promoted a while.
+
+RETURNS:
+    + Block* of the head of the queue.
+*/
+static Block *shuffleQueue(Block **blocks, int n)
+{
+    Block *swap;
+    int i, j;
+
+    for (i = n - 1; i > 0; i--)
+    {
+        j = rand() % (i + 1);
+        swap = blocks[i];
+        blocks[i] = blocks[j];
+        blocks[j] = swap;
+    }
+    for (i = 0; i < n - 1; i++)
+        blocks[i]->next = blocks[i + 1]->id;
+    blocks[n - 1]->next = PCB_NIL;
+
+    return blocks[0];
+}
+
+/*
+DESCRIPTION:
+    - Queue stress mode. Grows a population of `count` blocks, doubling from
+    `STRESS_FIRST_CHECKPOINT`. At every checkpoint the blocks are linked into
+    one shuffled queue, and it prints the average creation time of the last
+    batch, the time per job of a walk down the queue, the time per job of a
+    starvation pass that checks and resets every job the way a promotion
+    does, and the resident size of the dispatcher.
+
+RETURNS:
+    + The number of blocks that were created.
+*/
+int runQueueStress(int count)
+{
+    Block **blocks, *head, *p;
+    int live = 0, checkpoint = STRESS_FIRST_CHECKPOINT, batch_start, i;
+    int64_t started, batch_total, walk_ns;
+    uint64_t walked, promoted;
+
+    if (!(blocks = (Block **)malloc(count * sizeof(Block *))))
+    {
+        fprintf(stderr, "ERROR: Could not allocate stress population\n");
+        return 0;
+    }
+
+    printf("Block: %zu bytes, side table: %zu bytes\n", sizeof(Block),
+           sizeof(BlockInfo));
+    printf("%10s%12s%12s%12s%12s\n", "blocks", "create_ns", "walk_ns",
+           "starve_ns", "rss_kb");
+
+    while (live < count)
+    {
+        if (checkpoint > count)
+            checkpoint = count;
+
+        batch_start = live;
+        started = monotonicNanos();
+        while (live < checkpoint && (blocks[live] = createNullBlock()))
+        {
+            blocks[live]->remaining_cpu_time = live % STRESS_SAMPLE;
+            blocks[live]->last_queued = live % STRESS_STARVATION_WINDOW;
+            live++;
+        }
+        batch_total = monotonicNanos() - started;
+
+        if (live == batch_start)
+            break;
+        head = shuffleQueue(blocks, live);
+
+        started = monotonicNanos();
+        walked = 0;
+        for (p = head; p; p = nextBlock(p))
+            walked += p->remaining_cpu_time >= 0;
+        walk_ns = monotonicNanos() - started;
+
+        /*
+        NOTE:
+            - Every block was last queued within one window, so at twice the
+            window all of them are found starving and promoted.
+        */
+        started = monotonicNanos();
+        promoted = 0;
+        for (p = head; p; p = nextBlock(p))
+        {
+            if (2 * STRESS_STARVATION_WINDOW - p->last_queued -
+                    p->cycle_time <
+                STRESS_STARVATION_WINDOW)
+                continue;
+            promoted++;
+            p->cycle_time = 0;
+            p->priority = PCB_PRIORITY_0;
+            p->last_queued = 0;
+        }
+
+        printf("%10d%12.1f%12.1f%12.1f%12ld\n", live,
+               (double)batch_total / (live - batch_start),
+               (double)walk_ns / live,
+               (double)(monotonicNanos() - started) / live,
+               residentKilobytes());
+        fflush(stdout);
+
+        if (walked != (uint64_t)live || promoted != (uint64_t)live)
+            fprintf(stderr, "WARNING: Queue walk lost blocks\n");
+
+        if (live < checkpoint)
+        {
+            printf("Stopped growing at %d blocks\n", live);
+            break;
+        }
+        checkpoint *= 2;
+    }
+
+    for (i = 0; i < live; i++)
+        freeBlock(blocks[i]);
+    free(blocks);
+
+    return live;
+}
@@ -0,0 +1,435 @@
+/*
+    tracesort - sort a jobs file by arrival time, however large it is
+
+    usage:
+
+        ./tracesort [-m <megabytes>] [-t <directory>] <input> <output>
+
+    The input is read in runs of up to `-m` megabytes (default 256). Each
+    run is sorted in memory and written to an unlinked temporary file in
+    `-t` (default $TMPDIR, or /tmp). The runs are then merged, at most
+    TRACESORT_FAN_IN at a time, into the output. Jobs that arrive together
+    keep the order they had in the input. Blank lines are dropped, and
+    lines without an arrival time are kept and moved to the end, so that
+    the dispatcher can still quarantine them.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <math.h>
+
+#ifndef FALSE
+#define FALSE (0)
+#endif
+
+#ifndef TRUE
+#define TRUE (1)
+#endif
+
+#define TRACESORT_DEFAULT_MB (256)
+#define TRACESORT_FAN_IN (64)
+#define TRACESORT_OPTSTRING "m:t:"
+
+/*
+NOTE:
+    - One line of the trace and the arrival it is sorted by. `text` points
+    into the run's arena and keeps its newline.
+*/
+typedef struct
+{
+    double arrival;
+    char *text;
+} Line;
+
+/*
+NOTE:
+    - One run being merged, positioned at its next line.
+*/
+typedef struct
+{
+    FILE *file;
+    char *text;
+    size_t size;
+    double arrival;
+    int run;
+} Cursor;
+
+static const char *temp_dir = NULL;
+
+/*
+DESCRIPTION:
+    - Finds the arrival time a line is sorted by. Lines without one go after
+    every job.
+
+RETURNS:
+    + The arrival time, or HUGE_VAL if the line has none.
+*/
+static double arrivalOf(const char *text)
+{
+    char *end;
+    double arrival = strtod(text, &end);
+
+    return end == text ? HUGE_VAL : arrival;
+}
+
+/*
+DESCRIPTION:
+    - Compares two lines by arrival for `qsort()`. Equal arrivals are ordered
+    by where the lines sit in the arena, which is the order they were read.
+
+RETURNS:
+    + Negative, zero or positive as per `qsort()` conventions.
+*/
+static int compareLines(const void *a, const void *b)
+{
+    const Line *x = (const Line *)a;
+    const Line *y = (const Line *)b;
+
+    if (x->arrival != y->arrival)
+        return (x->arrival > y->arrival) - (x->arrival < y->arrival);
+
+    return (x->text > y->text) - (x->text < y->text);
+}
+
+/*
+DESCRIPTION:
+    - Opens a temporary file for a run. It is unlinked straight away, so it
+    goes when it is closed or the tool dies.
+
+RETURNS:
+    + FILE* of the run, open for reading and writing.
+    + NULL if it could not be created.
+*/
+static FILE *createRun()
+{
+    char path[4096];
+    FILE *run;
+    int fd;
+
+    snprintf(path, sizeof(path), "%s/tracesort-XXXXXX", temp_dir);
+    if ((fd = mkstemp(path)) < 0)
+    {
+        perror("ERROR: Could not create run file");
+        return NULL;
+    }
+    unlink(path);
+
+    if (!(run = fdopen(fd, "w+")))
+    {
+        perror("ERROR: Could not open run file");
+        close(fd);
+    }
+
+    return run;
+}
+
+/*
+DESCRIPTION:
+    - Reads the next line of a run into cursor `c`.
+
+RETURNS:
+    + TRUE if a line was read.
+    + FALSE at the end of the run.
+*/
+static char advanceCursor(Cursor *c)
+{
+    if (getline(&c->text, &c->size, c->file) < 0)
+        return FALSE;
+
+    c->arrival = arrivalOf(c->text);
+
+    return TRUE;
+}
+
+/*
+DESCRIPTION:
+    - Orders two cursors by the arrival of their next line. Ties go to the
+    earlier run, which keeps lines that arrive together in input order.
+
+RETURNS:
+    + TRUE if `a` comes first.
+    + FALSE otherwise.
+*/
+static char isAhead(Cursor *a, Cursor *b)
+{
+    if (a->arrival != b->arrival)
+        return a->arrival < b->arrival;
+
+    return a->run < b->run;
+}
+
+/*
+DESCRIPTION:
+    - Moves cursor `i` of the heap down until neither child is ahead of it.
+
+RETURNS:
+    + Nothing.
+*/
+static void siftCursor(Cursor *heap, int size, int i)
+{
+    Cursor c = heap[i];
+    int child;
+
+    while ((child = 2 * i + 1) < size)
+    {
+        if (child + 1 < size && isAhead(&heap[child + 1], &heap[child]))
+            child++;
+        if (!isAhead(&heap[child], &c))
+            break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = c;
+}
+
+/*
+DESCRIPTION:
+    - Merges `count` sorted runs into `out` through a min-heap of cursors,
+    one per run. The runs are closed as they run out.
+
+RETURNS:
+    + TRUE if the runs were merged.
+    + FALSE if failed at allocating memory or writing.
+*/
+static char mergeRuns(FILE **runs, int count, FILE *out)
+{
+    Cursor *heap;
+    int size = 0, i;
+    char ok = TRUE;
+
+    if (!(heap = (Cursor *)calloc(count, sizeof(Cursor))))
+    {
+        fprintf(stderr, "ERROR: Could not merge runs\n");
+        return FALSE;
+    }
+
+    for (i = 0; i < count; i++)
+    {
+        rewind(runs[i]);
+        heap[size].file = runs[i];
+        heap[size].run = i;
+        if (advanceCursor(&heap[size]))
+            size++;
+        else
+            fclose(runs[i]);
+    }
+    for (i = size / 2 - 1; i >= 0; i--)
+        siftCursor(heap, size, i);
+
+    while (size)
+    {
+        if (fputs(heap[0].text, out) == EOF)
+            ok = FALSE;
+        if (!advanceCursor(&heap[0]))
+        {
+            fclose(heap[0].file);
+            free(heap[0].text);
+            heap[0] = heap[--size];
+        }
+        siftCursor(heap, size, 0);
+    }
+
+    free(heap);
+    if (!ok)
+        perror("ERROR: Could not write merged runs");
+
+    return ok;
+}
+
+/*
+DESCRIPTION:
+    - Sorts the lines read so far in the arena and writes them out in order,
+    to `out` if given and to a new run otherwise.
+
+RETURNS:
+    + FILE* of the run, or `out`.
+    + NULL if the run could not be written.
+*/
+static FILE *flushRun(Line *lines, size_t count, FILE *out)
+{
+    FILE *run = out ? out : createRun();
+    size_t i;
+
+    if (!run)
+        return NULL;
+
+    qsort(lines, count, sizeof(Line), compareLines);
+    for (i = 0; i < count; i++)
+    {
+        if (fputs(lines[i].text, run) == EOF)
+        {
+            perror("ERROR: Could not write run");
+            return NULL;
+        }
+    }
+
+    return run;
+}
+
+int main(int argc, char *argv[])
+{
+    FILE *in, *out, **runs = NULL, **grown, *merged;
+    Line *lines = NULL;
+    char *arena, *text = NULL;
+    size_t budget = (size_t)TRACESORT_DEFAULT_MB << 20;
+    size_t used = 0, line_count = 0, line_capacity = 0, size = 0, need;
+    ssize_t length;
+    int run_count = 0, opt, i, group;
+
+    while ((opt = getopt(argc, argv, TRACESORT_OPTSTRING)) != -1)
+    {
+        switch (opt)
+        {
+        case 'm':
+            budget = (size_t)atol(optarg) << 20;
+            break;
+        case 't':
+            temp_dir = optarg;
+            break;
+        default:
+            fprintf(stderr, "Usage: %s [-m <megabytes>] [-t <directory>] "
+                            "<input> <output>\n",
+                    argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (argc - optind != 2 || !budget)
+    {
+        fprintf(stderr, "Usage: %s [-m <megabytes>] [-t <directory>] "
+                        "<input> <output>\n",
+                argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    if (!temp_dir && !(temp_dir = getenv("TMPDIR")))
+        temp_dir = "/tmp";
+
+    if (!(in = fopen(argv[optind], "r")))
+    {
+        perror("ERROR: Could not open input");
+        exit(EXIT_FAILURE);
+    }
+    if (!(arena = (char *)malloc(budget)))
+    {
+        fprintf(stderr, "ERROR: Could not allocate %zu MB\n", budget >> 20);
+        exit(EXIT_FAILURE);
+    }
+
+    /*
+    NOTE:
+        - Fill the arena with lines, and sort and spill it as a run whenever
+        the next line would not fit.
+    */
+    while ((length = getline(&text, &size, in)) >= 0)
+    {
+        if (text[strspn(text, " \t\r\n")] == '\0')
+            continue;
+        need = length + (text[length - 1] != '\n') + 1;
+        if (need > budget)
+        {
+            fprintf(stderr, "ERROR: A line is longer than the memory budget\n");
+            exit(EXIT_FAILURE);
+        }
+
+        if (used + need > budget)
+        {
+            if (!(grown = (FILE **)realloc(runs, (run_count + 1) *
+                                                     sizeof(FILE *))))
+            {
+                fprintf(stderr, "ERROR: Could not track runs\n");
+                exit(EXIT_FAILURE);
+            }
+            runs = grown;
+            if (!(runs[run_count++] = flushRun(lines, line_count, NULL)))
+                exit(EXIT_FAILURE);
+            used = 0;
+            line_count = 0;
+        }
+
+        if (line_count == line_capacity)
+        {
+            line_capacity = line_capacity ? 2 * line_capacity : 4096;
+            if (!(lines = (Line *)realloc(lines, line_capacity * sizeof(Line))))
+            {
+                fprintf(stderr, "ERROR: Could not index lines\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        memcpy(arena + used, text, length);
+        arena[used + need - 2] = '\n';
+        arena[used + need - 1] = '\0';
+        lines[line_count].text = arena + used;
+        lines[line_count].arrival = arrivalOf(arena + used);
+        line_count++;
+        used += need;
+    }
+    fclose(in);
+    free(text);
+
+    if (!(out = fopen(argv[optind + 1], "w")))
+    {
+        perror("ERROR: Could not open output");
+        exit(EXIT_FAILURE);
+    }
+
+    /*
+    NOTE:
+        - A trace that fits in memory is written out directly. Otherwise the
+        last run is spilled like the others and they are merged, a group at
+        a time, until few enough are left to merge into the output.
+    */
+    if (!run_count)
+    {
+        if (!flushRun(lines, line_count, out))
+            exit(EXIT_FAILURE);
+    }
+    else
+    {
+        if (!(grown = (FILE **)realloc(runs, (run_count + 1) *
+                                                 sizeof(FILE *))))
+        {
+            fprintf(stderr, "ERROR: Could not track runs\n");
+            exit(EXIT_FAILURE);
+        }
+        runs = grown;
+        if (!(runs[run_count++] = flushRun(lines, line_count, NULL)))
+            exit(EXIT_FAILURE);
+        free(lines);
+        free(arena);
+        lines = NULL;
+
+        while (run_count > TRACESORT_FAN_IN)
+        {
+            for (i = 0, group = 0; i < run_count; i += TRACESORT_FAN_IN)
+            {
+                int n = run_count - i < TRACESORT_FAN_IN ? run_count - i
+                                                         : TRACESORT_FAN_IN;
+                if (!(merged = createRun()) ||
+                    !mergeRuns(runs + i, n, merged))
+                {
+                    exit(EXIT_FAILURE);
+                }
+                runs[group++] = merged;
+            }
+            run_count = group;
+        }
+
+        if (!mergeRuns(runs, run_count, out))
+            exit(EXIT_FAILURE);
+        free(runs);
+        arena = NULL;
+    }
+
+    free(lines);
+    free(arena);
+    if (fclose(out) == EOF)
+    {
+        perror("ERROR: Could not write output");
+        exit(EXIT_FAILURE);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,366 @@
+#include <window.h>
+
+/*
+NOTE:
+    - Rolling windows over the last WINDOW_LONG seconds of wall time, for a
+    dispatcher that runs for much longer than its lifetime sums mean any-
+    thing. Both rings are fixed in size, so memory does not grow with the
+    length of the run. Seconds are counted from the first time either ring
+    is used.
+*/
+static WindowSlot slots[WINDOW_SLOTS];
+static DepthSample samples[WINDOW_SAMPLES];
+static uint64_t sampled = 0;
+static int64_t started_ns = 0;
+
+/*
+DESCRIPTION:
+    - Finds how many whole seconds the windows have been running for.
+
+RETURNS:
+    + The current second.
+*/
+static uint64_t currentSecond()
+{
+    int64_t now = monotonicNanos();
+
+    if (!started_ns)
+        started_ns = now;
+
+    return (uint64_t)((now - started_ns) / EVENT_NANOS_PER_SECOND);
+}
+
+/*
+DESCRIPTION:
+    - Finds the histogram bin of time `value`. Small values have a bin each,
+    and every power of two above is split into WINDOW_SUB_BINS bins.
+
+RETURNS:
+    + The bin, the last one for anything too large for the others.
+*/
+static int binOf(uint64_t value)
+{
+    int power, bin;
+
+    if (value < WINDOW_EXACT_BINS)
+        return (int)value;
+
+    power = 63 - __builtin_clzll(value);
+    bin = WINDOW_EXACT_BINS +
+          (power - WINDOW_SUB_BITS - 1) * WINDOW_SUB_BINS +
+          (int)((value >> (power - WINDOW_SUB_BITS)) & (WINDOW_SUB_BINS - 1));
+
+    return bin < WINDOW_BINS ? bin : WINDOW_BINS - 1;
+}
+
+/*
+DESCRIPTION:
+    - Finds the largest time that falls into histogram bin `bin`.
+
+RETURNS:
+    + The top of the bin.
+*/
+static uint64_t binTop(int bin)
+{
+    int shift, sub;
+
+    if (bin < WINDOW_EXACT_BINS)
+        return (uint64_t)bin;
+
+    shift = (bin - WINDOW_EXACT_BINS) / WINDOW_SUB_BINS + 1;
+    sub = (bin - WINDOW_EXACT_BINS) % WINDOW_SUB_BINS;
+
+    return ((uint64_t)(WINDOW_SUB_BINS + sub + 1) << shift) - 1;
+}
+
+/*
+DESCRIPTION:
+    - Counts a job that has just finished with times `turnaround`, `waiting`
+    and `response` towards the current period. A `response` of
+    WINDOW_NO_RESPONSE, for a job that never ran, is left out.
+
+RETURNS:
+    + Nothing.
+*/
+void noteFinished(uint64_t turnaround, uint64_t waiting, uint64_t response)
+{
+    uint64_t period = currentSecond() / WINDOW_SLOT_SECONDS;
+    WindowSlot *slot = &slots[period % WINDOW_SLOTS];
+
+    if (slot->period != period)
+    {
+        memset(slot, 0, sizeof(WindowSlot));
+        slot->period = period;
+    }
+    slot->finished++;
+    slot->histogram[WINDOW_TURNAROUND][binOf(turnaround)]++;
+    slot->histogram[WINDOW_WAITING][binOf(waiting)]++;
+    if (response != WINDOW_NO_RESPONSE)
+    {
+        slot->responded++;
+        slot->histogram[WINDOW_RESPONSE][binOf(response)]++;
+    }
+}
+
+/*
+DESCRIPTION:
+    - Checks whether the queue depths have been sampled during the current
+    second yet. This is cheap, so it can be asked on every pass.
+
+RETURNS:
+    + TRUE if a sample is due.
+    + FALSE otherwise.
+*/
+char isDepthSampleDue()
+{
+    return !sampled || currentSecond() != sampled - 1;
+}
+
+/*
+DESCRIPTION:
+    - Stores queue depths `depths`, one per WINDOW_QUEUES, as the sample of
+    the current second. Only the dispatcher calls this.
+
+RETURNS:
+    + Nothing.
+*/
+void sampleDepths(const uint32_t *depths)
+{
+    uint64_t second = currentSecond();
+    DepthSample *s = &samples[second % WINDOW_SAMPLES];
+    uint32_t sequence = s->sequence;
+    int i;
+
+    __atomic_store_n(&s->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (i = 0; i < WINDOW_QUEUES; i++)
+        __atomic_store_n(&s->depth[i], depths[i], __ATOMIC_RELAXED);
+    __atomic_store_n(&s->second, second, __ATOMIC_RELAXED);
+    __atomic_store_n(&s->sequence, sequence + 2, __ATOMIC_RELEASE);
+
+    __atomic_store_n(&sampled, second + 1, __ATOMIC_RELEASE);
+}
+
+/*
+DESCRIPTION:
+    - Copies up to `count` of the latest queue depth samples into `series`,
+    newest first. Seconds that were never sampled are skipped. Safe to call
+    from any thread while the dispatcher keeps sampling.
+
+RETURNS:
+    + The number of samples copied.
+*/
+int readDepthSeries(DepthSample *series, int count)
+{
+    uint64_t newest = __atomic_load_n(&sampled, __ATOMIC_ACQUIRE);
+    uint64_t second;
+    uint32_t sequence;
+    DepthSample *s, copy;
+    int age, copied = 0, i;
+
+    for (age = 0; age < count && age < WINDOW_SAMPLES &&
+                  (uint64_t)age < newest;
+         age++)
+    {
+        second = newest - 1 - age;
+        s = &samples[second % WINDOW_SAMPLES];
+
+        /*
+        NOTE:
+            - Read the sample again for as long as the dispatcher was writing
+            it at the time.
+        */
+        do
+        {
+            while ((sequence = __atomic_load_n(&s->sequence,
+                                               __ATOMIC_ACQUIRE)) & 1)
+                ;
+            for (i = 0; i < WINDOW_QUEUES; i++)
+                copy.depth[i] = __atomic_load_n(&s->depth[i],
+                                                __ATOMIC_RELAXED);
+            copy.second = __atomic_load_n(&s->second, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        } while (__atomic_load_n(&s->sequence, __ATOMIC_RELAXED) != sequence);
+
+        if (copy.second != second)
+            continue;
+        copy.sequence = sequence;
+        series[copied++] = copy;
+    }
+
+    return copied;
+}
+
+/*
+DESCRIPTION:
+    - Sums the slots of the last `span` seconds up to second `now` into
+    `histogram`, and how many of their jobs had a response time into
+    `responded`.
+
+RETURNS:
+    + The number of jobs finished in the window.
+*/
+static uint64_t sumWindow(int span, uint64_t now,
+                          uint32_t histogram[WINDOW_METRICS][WINDOW_BINS],
+                          uint64_t *responded)
+{
+    uint64_t last = now / WINDOW_SLOT_SECONDS, finished = 0;
+    uint64_t first = last + 1 >= (uint64_t)(span / WINDOW_SLOT_SECONDS)
+                         ? last + 1 - span / WINDOW_SLOT_SECONDS
+                         : 0;
+    int i, m, b;
+
+    memset(histogram, 0, WINDOW_METRICS * WINDOW_BINS * sizeof(uint32_t));
+    *responded = 0;
+    for (i = 0; i < WINDOW_SLOTS; i++)
+    {
+        if (slots[i].period < first || slots[i].period > last ||
+            !slots[i].finished)
+            continue;
+
+        finished += slots[i].finished;
+        *responded += slots[i].responded;
+        for (m = 0; m < WINDOW_METRICS; m++)
+            for (b = 0; b < WINDOW_BINS; b++)
+                histogram[m][b] += slots[i].histogram[m][b];
+    }
+
+    return finished;
+}
+
+/*
+DESCRIPTION:
+    - Finds the `percent` percentile of the `count` times in `histogram`.
+
+RETURNS:
+    + The top of the bin the percentile falls in, or zero with no times.
+*/
+static uint64_t percentileOf(uint32_t *histogram, uint64_t count, int percent)
+{
+    uint64_t rank = (count * percent + 99) / 100, seen = 0;
+    int b;
+
+    for (b = 0; b < WINDOW_BINS && count; b++)
+    {
+        if ((seen += histogram[b]) >= rank)
+            return binTop(b);
+    }
+
+    return 0;
+}
+
+/*
+DESCRIPTION:
+    - Appends formatted text to `buffer`, which holds `*length` characters out
+    of `size`. Text that does not fit is cut off.
+
+RETURNS:
+    + Nothing.
+*/
+static void appendText(char *buffer, size_t size, size_t *length,
+                       const char *format, ...)
+{
+    va_list args;
+    int written;
+
+    if (*length + 1 >= size)
+        return;
+
+    va_start(args, format);
+    written = vsnprintf(buffer + *length, size - *length, format, args);
+    va_end(args);
+
+    if (written > 0)
+        *length = *length + written < size ? *length + written : size - 1;
+}
+
+/*
+DESCRIPTION:
+    - Writes the rolling windows into `buffer` for the stats endpoint, as
+    `window <seconds> ...` lines for each of the 1 minute, 5 minute and 1
+    hour windows, then the latest WINDOW_SERIES_SHOWN queue depth samples as
+    `series <seconds ago> ...` lines. A window is made of whole slots of
+    WINDOW_SLOT_SECONDS, the last of which is the one being filled.
+
+RETURNS:
+    + The length of what was written.
+*/
+size_t writeWindowStats(char *buffer, size_t size)
+{
+    static const int spans[] = {WINDOW_SHORT, WINDOW_MEDIUM, WINDOW_LONG};
+    static const char *names[WINDOW_METRICS] = {"turnaround", "waiting",
+                                                "response"};
+    static DepthSample series[WINDOW_SAMPLES];
+    static uint32_t histogram[WINDOW_METRICS][WINDOW_BINS];
+    uint64_t now = currentSecond(), finished, responded, timed, covered;
+    uint64_t sum[WINDOW_QUEUES];
+    uint32_t most[WINDOW_QUEUES];
+    int count = readDepthSeries(series, WINDOW_SAMPLES);
+    int i, j, m, n;
+    size_t length = 0;
+
+    if (size)
+        buffer[0] = '\0';
+
+    for (i = 0; i < (int)(sizeof(spans) / sizeof(spans[0])); i++)
+    {
+        finished = sumWindow(spans[i], now, histogram, &responded);
+        covered = spans[i] - WINDOW_SLOT_SECONDS +
+                  now % WINDOW_SLOT_SECONDS + 1;
+        if (covered > now + 1)
+            covered = now + 1;
+
+        appendText(buffer, size, &length,
+                   "window %d finished %" PRIu64 " per_second %.3f\n",
+                   spans[i], finished, (double)finished / (double)covered);
+        for (m = 0; m < WINDOW_METRICS; m++)
+        {
+            timed = m == WINDOW_RESPONSE ? responded : finished;
+            appendText(buffer, size, &length,
+                       "window %d %s p50 %" PRIu64 " p90 %" PRIu64
+                       " p99 %" PRIu64 "\n",
+                       spans[i], names[m],
+                       percentileOf(histogram[m], timed, 50),
+                       percentileOf(histogram[m], timed, 90),
+                       percentileOf(histogram[m], timed, 99));
+        }
+
+        memset(sum, 0, sizeof(sum));
+        memset(most, 0, sizeof(most));
+        for (j = 0, n = 0;
+             j < count && now - series[j].second < (uint64_t)spans[i];
+             j++, n++)
+        {
+            for (m = 0; m < WINDOW_QUEUES; m++)
+            {
+                sum[m] += series[j].depth[m];
+                if (series[j].depth[m] > most[m])
+                    most[m] = series[j].depth[m];
+            }
+        }
+        if (!n)
+            n = 1;
+
+        appendText(buffer, size, &length,
+                   "window %d depth_avg jdq %.1f edf %.1f zero %.1f one %.1f "
+                   "two %.1f\n",
+                   spans[i], (double)sum[WINDOW_JDQ] / n,
+                   (double)sum[WINDOW_EDF] / n, (double)sum[WINDOW_ZERO] / n,
+                   (double)sum[WINDOW_ONE] / n, (double)sum[WINDOW_TWO] / n);
+        appendText(buffer, size, &length,
+                   "window %d depth_max jdq %u edf %u zero %u one %u two %u\n",
+                   spans[i], most[WINDOW_JDQ], most[WINDOW_EDF],
+                   most[WINDOW_ZERO], most[WINDOW_ONE], most[WINDOW_TWO]);
+    }
+
+    for (j = 0; j < count && j < WINDOW_SERIES_SHOWN; j++)
+    {
+        appendText(buffer, size, &length,
+                   "series %" PRIu64 " jdq %u edf %u zero %u one %u two %u\n",
+                   now - series[j].second, series[j].depth[WINDOW_JDQ],
+                   series[j].depth[WINDOW_EDF], series[j].depth[WINDOW_ZERO],
+                   series[j].depth[WINDOW_ONE], series[j].depth[WINDOW_TWO]);
+    }
+
+    return length;
+}